@@ -0,0 +1,524 @@
+#ifndef BTREEINDEX_H
+#define BTREEINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include "Utils.h"
+#include "Value.h"
+#include "Column.h"
+
+// Key order of the tree. Doubles put NaN after every other value so the order stays total.
+template <typename Key>
+struct KeyOrder {
+    static bool less(const Key& a, const Key& b) { return a < b; }
+};
+
+template <>
+struct KeyOrder<double> {
+    static bool less(double a, double b) { return a < b || (std::isnan(b) && !std::isnan(a)); }
+};
+
+// Key interval for a range scan; each side is either unbounded or an inclusive/exclusive bound
+template <typename Key>
+struct KeyRange {
+    bool hasLow = false;
+    bool lowInclusive = true;
+    Key low{};
+    bool hasHigh = false;
+    bool highInclusive = true;
+    Key high{};
+
+    // Narrow the range by "key op constant"; returns false for operators that are not a
+    // range (<>)
+    bool restrict(CompareOp op, const Key& constant) {
+        switch (op) {
+            case CompareOp::EQ: raiseLow(constant, true); lowerHigh(constant, true); return true;
+            case CompareOp::GT: raiseLow(constant, false); return true;
+            case CompareOp::GE: raiseLow(constant, true); return true;
+            case CompareOp::LT: lowerHigh(constant, false); return true;
+            case CompareOp::LE: lowerHigh(constant, true); return true;
+            default: return false;
+        }
+    }
+
+    [[nodiscard]] bool empty() const {
+        if (!hasLow || !hasHigh) return false;
+        if (KeyOrder<Key>::less(high, low)) return true;
+        return !KeyOrder<Key>::less(low, high) && !(lowInclusive && highInclusive);
+    }
+
+private:
+    void raiseLow(const Key& k, bool inclusive) {
+        if (!hasLow || KeyOrder<Key>::less(low, k) || (!KeyOrder<Key>::less(k, low) && !inclusive)) {
+            low = k;
+            lowInclusive = inclusive;
+            hasLow = true;
+        }
+    }
+
+    void lowerHigh(const Key& k, bool inclusive) {
+        if (!hasHigh || KeyOrder<Key>::less(k, high) || (!KeyOrder<Key>::less(high, k) && !inclusive)) {
+            high = k;
+            highInclusive = inclusive;
+            hasHigh = true;
+        }
+    }
+};
+
+// B+tree over (key, row id) entries, ordered by key and then row id, so equal keys need no
+// duplicate handling and come out in row order. Nodes live in two vectors and refer to each
+// other by position; they are cache-line aligned and their key arrays span a few whole
+// cache lines (32 numeric or 16 string keys). Leaves are linked both ways for ordered scans.
+// Erasing does not merge nodes: a leaf may become empty and is simply skipped by scans
+// until the tree is rebuilt (build() or remapRows()).
+template <typename Key>
+class BPlusTree {
+public:
+    using KeyType = Key;
+    static constexpr size_t CAPACITY = std::is_arithmetic<Key>::value ? 32 : 16;
+
+    [[nodiscard]] size_t size() const { return entries; }
+
+    void clear() {
+        leaves.clear();
+        inners.clear();
+        root = NONE;
+        height = 0;
+        entries = 0;
+    }
+
+    // Bulk load from the column's cells (keys by row id): sorts the entries and packs them
+    // into full leaves, then builds the inner levels bottom-up
+    void build(const std::vector<Key>& cells) {
+        clear();
+        if (cells.empty()) return;
+        size_t n = cells.size();
+
+        // Entries are sorted as (key, row id) pairs; strings by view, so sorting moves no text
+        using SortKey = std::conditional_t<std::is_same<Key, std::string>::value, std::string_view, Key>;
+        std::vector<std::pair<SortKey, size_t>> sorted;
+        sorted.reserve(n);
+        for (size_t row = 0; row < n; row++) sorted.emplace_back(cells[row], row);
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            if (KeyOrder<SortKey>::less(a.first, b.first)) return true;
+            if (KeyOrder<SortKey>::less(b.first, a.first)) return false;
+            return a.second < b.second;
+        });
+
+        pack(n, [&](size_t i, Key& key, uint64_t& row) {
+            row = sorted[i].second;
+            key = cells[row];
+        });
+    }
+
+    // Renumber the rows after a table compaction: row id i becomes newIds[i], entries mapped
+    // to SIZE_MAX are dropped. The mapping keeps the entry order, so the surviving entries are
+    // taken from the leaf chain as they are and packed into a fresh tree without sorting.
+    void remapRows(const std::vector<size_t>& newIds) {
+        std::vector<std::pair<Key, size_t>> kept;
+        kept.reserve(entries);
+        for (uint32_t id = root == NONE ? NONE : edgeLeaf(false); id != NONE; id = leaves[id].next) {
+            Leaf& leaf = leaves[id];
+            for (uint32_t i = 0; i < leaf.count; i++) {
+                size_t row = newIds[leaf.rows[i]];
+                if (row != SIZE_MAX) kept.emplace_back(std::move(leaf.keys[i]), row);
+            }
+        }
+        clear();
+        pack(kept.size(), [&kept](size_t i, Key& key, uint64_t& row) {
+            key = std::move(kept[i].first);
+            row = kept[i].second;
+        });
+    }
+
+    void insert(const Key& key, size_t row) {
+        if (root == NONE) {
+            root = newLeaf();
+            height = 0;
+        }
+        Split split;
+        if (insertInto(root, height, key, row, split)) {
+            uint32_t id = newInner();
+            Inner& inner = inners[id];
+            inner.count = 1;
+            inner.keys[0] = std::move(split.key);
+            inner.rows[0] = split.row;
+            inner.children[0] = root;
+            inner.children[1] = split.node;
+            root = id;
+            height++;
+        }
+        entries++;
+    }
+
+    void erase(const Key& key, size_t row) {
+        if (root == NONE) return;
+        Leaf& leaf = leaves[findLeaf(key, row)];
+        uint32_t pos = lowerBound(leaf, key, row);
+        if (pos == leaf.count || !sameEntry(leaf.keys[pos], leaf.rows[pos], key, row)) return;
+        for (uint32_t i = pos; i + 1 < leaf.count; i++) {
+            leaf.keys[i] = std::move(leaf.keys[i + 1]);
+            leaf.rows[i] = leaf.rows[i + 1];
+        }
+        leaf.count--;
+        entries--;
+    }
+
+    // Calls visit(rowId) for the entries in range, in key order; visit returns false to stop
+    template <typename Visit>
+    void scan(const KeyRange<Key>& range, Visit&& visit) const {
+        if (root == NONE || range.empty()) return;
+        uint32_t id;
+        uint32_t pos = 0;
+        if (range.hasLow) {
+            size_t startRow = range.lowInclusive ? 0 : SIZE_MAX;
+            id = findLeaf(range.low, startRow);
+            pos = lowerBound(leaves[id], range.low, startRow);
+        } else {
+            id = edgeLeaf(false);
+        }
+        for (; id != NONE; id = leaves[id].next, pos = 0) {
+            const Leaf& leaf = leaves[id];
+            for (; pos < leaf.count; pos++) {
+                if (range.hasHigh && pastHigh(leaf.keys[pos], range)) return;
+                if (!visit((size_t)leaf.rows[pos])) return;
+            }
+        }
+    }
+
+    // Calls visit(rowId) for all entries in descending key order; equal keys still come
+    // out in ascending row order. visit returns false to stop.
+    template <typename Visit>
+    void scanDescending(Visit&& visit) const {
+        if (root == NONE) return;
+        std::vector<size_t> run; // rows of the current key, collected backwards
+        const Key* runKey = nullptr;
+        for (uint32_t id = edgeLeaf(true); id != NONE; id = leaves[id].prev) {
+            const Leaf& leaf = leaves[id];
+            for (uint32_t i = leaf.count; i-- > 0;) {
+                if (runKey && (KeyOrder<Key>::less(leaf.keys[i], *runKey) || KeyOrder<Key>::less(*runKey, leaf.keys[i]))) {
+                    for (auto it = run.rbegin(); it != run.rend(); ++it) {
+                        if (!visit(*it)) return;
+                    }
+                    run.clear();
+                }
+                runKey = &leaf.keys[i];
+                run.push_back((size_t)leaf.rows[i]);
+            }
+        }
+        for (auto it = run.rbegin(); it != run.rend(); ++it) {
+            if (!visit(*it)) return;
+        }
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct alignas(64) Leaf {
+        Key keys[CAPACITY];
+        uint64_t rows[CAPACITY];
+        uint32_t count = 0;
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+    };
+
+    // children[i] holds the entries e with separator[i - 1] <= e < separator[i]
+    struct alignas(64) Inner {
+        Key keys[CAPACITY];
+        uint64_t rows[CAPACITY];
+        uint32_t children[CAPACITY + 1];
+        uint32_t count = 0; // separators; there is one more child
+    };
+
+    // New right sibling produced by a split, and the separator in front of it
+    struct Split {
+        Key key{};
+        size_t row = 0;
+        uint32_t node = NONE;
+    };
+
+    std::vector<Leaf> leaves;
+    std::vector<Inner> inners;
+    uint32_t root = NONE;
+    size_t height = 0; // inner levels above the leaves
+    size_t entries = 0;
+
+    // Fills full leaves with n entries in (key, row id) order, fill(i, key, row) producing
+    // the i-th one, then builds the inner levels bottom-up. The tree must be empty.
+    template <typename Fill>
+    void pack(size_t n, Fill fill) {
+        if (n == 0) return;
+        size_t numLeaves = (n + CAPACITY - 1) / CAPACITY;
+        leaves.reserve(numLeaves);
+        inners.reserve(numLeaves / CAPACITY + 16);
+
+        // Nodes of the level being built, with the smallest entry below each
+        std::vector<uint32_t> level;
+        std::vector<std::pair<Key, size_t>> firsts;
+        for (size_t i = 0; i < n; i += CAPACITY) {
+            uint32_t id = newLeaf();
+            Leaf& leaf = leaves[id];
+            size_t count = std::min(CAPACITY, n - i);
+            for (size_t j = 0; j < count; j++) fill(i + j, leaf.keys[j], leaf.rows[j]);
+            leaf.count = (uint32_t)count;
+            if (!level.empty()) {
+                leaves[level.back()].next = id;
+                leaf.prev = level.back();
+            }
+            level.push_back(id);
+            firsts.emplace_back(leaf.keys[0], leaf.rows[0]);
+        }
+        entries = n;
+
+        while (level.size() > 1) {
+            std::vector<uint32_t> parents;
+            std::vector<std::pair<Key, size_t>> parentFirsts;
+            for (size_t i = 0; i < level.size(); i += CAPACITY + 1) {
+                uint32_t id = newInner();
+                Inner& inner = inners[id];
+                size_t count = std::min(CAPACITY + 1, level.size() - i);
+                inner.children[0] = level[i];
+                for (size_t j = 1; j < count; j++) {
+                    inner.keys[j - 1] = firsts[i + j].first;
+                    inner.rows[j - 1] = firsts[i + j].second;
+                    inner.children[j] = level[i + j];
+                }
+                inner.count = (uint32_t)(count - 1);
+                parents.push_back(id);
+                parentFirsts.push_back(std::move(firsts[i]));
+            }
+            level = std::move(parents);
+            firsts = std::move(parentFirsts);
+            height++;
+        }
+        root = level[0];
+    }
+
+    static bool entryLess(const Key& a, size_t rowA, const Key& b, size_t rowB) {
+        if (KeyOrder<Key>::less(a, b)) return true;
+        if (KeyOrder<Key>::less(b, a)) return false;
+        return rowA < rowB;
+    }
+
+    static bool sameEntry(const Key& a, size_t rowA, const Key& b, size_t rowB) {
+        return rowA == rowB && !KeyOrder<Key>::less(a, b) && !KeyOrder<Key>::less(b, a);
+    }
+
+    static bool pastHigh(const Key& key, const KeyRange<Key>& range) {
+        if (KeyOrder<Key>::less(range.high, key)) return true;
+        return !range.highInclusive && !KeyOrder<Key>::less(key, range.high);
+    }
+
+    uint32_t newLeaf() {
+        leaves.emplace_back();
+        return (uint32_t)(leaves.size() - 1);
+    }
+
+    uint32_t newInner() {
+        inners.emplace_back();
+        return (uint32_t)(inners.size() - 1);
+    }
+
+    // First position in the leaf whose entry is not below (key, row)
+    static uint32_t lowerBound(const Leaf& leaf, const Key& key, size_t row) {
+        uint32_t lo = 0, hi = leaf.count;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (entryLess(leaf.keys[mid], leaf.rows[mid], key, row)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Child of an inner node whose range contains (key, row)
+    static uint32_t childSlot(const Inner& inner, const Key& key, size_t row) {
+        uint32_t lo = 0, hi = inner.count;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (entryLess(key, row, inner.keys[mid], inner.rows[mid])) hi = mid;
+            else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    [[nodiscard]] uint32_t findLeaf(const Key& key, size_t row) const {
+        uint32_t id = root;
+        for (size_t level = height; level > 0; level--) {
+            const Inner& inner = inners[id];
+            id = inner.children[childSlot(inner, key, row)];
+        }
+        return id;
+    }
+
+    // Leftmost (or rightmost) leaf
+    [[nodiscard]] uint32_t edgeLeaf(bool last) const {
+        uint32_t id = root;
+        for (size_t level = height; level > 0; level--) {
+            const Inner& inner = inners[id];
+            id = inner.children[last ? inner.count : 0];
+        }
+        return id;
+    }
+
+    // Returns true if the node split; split then describes the new right sibling
+    bool insertInto(uint32_t id, size_t level, const Key& key, size_t row, Split& split) {
+        if (level == 0) return insertIntoLeaf(id, key, row, split);
+
+        uint32_t slot = childSlot(inners[id], key, row);
+        Split childSplit;
+        if (!insertInto(inners[id].children[slot], level - 1, key, row, childSplit)) return false;
+
+        if (inners[id].count < CAPACITY) {
+            insertSeparator(inners[id], slot, childSplit);
+            return false;
+        }
+
+        // Full: move the upper half to a new node and push the middle separator up
+        uint32_t rightId = newInner();
+        Inner& node = inners[id];
+        Inner& right = inners[rightId];
+        uint32_t mid = CAPACITY / 2;
+        for (uint32_t i = mid + 1; i < CAPACITY; i++) {
+            right.keys[i - mid - 1] = std::move(node.keys[i]);
+            right.rows[i - mid - 1] = node.rows[i];
+        }
+        for (uint32_t i = mid + 1; i <= CAPACITY; i++) right.children[i - mid - 1] = node.children[i];
+        right.count = CAPACITY - mid - 1;
+        node.count = mid;
+        split.key = std::move(node.keys[mid]);
+        split.row = node.rows[mid];
+        split.node = rightId;
+
+        if (slot <= mid) insertSeparator(node, slot, childSplit);
+        else insertSeparator(right, slot - mid - 1, childSplit);
+        return true;
+    }
+
+    // Adds the separator and right child of a split child at children[slot]
+    static void insertSeparator(Inner& node, uint32_t slot, Split& childSplit) {
+        for (uint32_t i = node.count; i > slot; i--) {
+            node.keys[i] = std::move(node.keys[i - 1]);
+            node.rows[i] = node.rows[i - 1];
+            node.children[i + 1] = node.children[i];
+        }
+        node.keys[slot] = std::move(childSplit.key);
+        node.rows[slot] = childSplit.row;
+        node.children[slot + 1] = childSplit.node;
+        node.count++;
+    }
+
+    bool insertIntoLeaf(uint32_t id, const Key& key, size_t row, Split& split) {
+        uint32_t pos = lowerBound(leaves[id], key, row);
+        if (leaves[id].count < CAPACITY) {
+            insertEntry(leaves[id], pos, key, row);
+            return false;
+        }
+
+        uint32_t rightId = newLeaf();
+        Leaf& leaf = leaves[id];
+        Leaf& right = leaves[rightId];
+        right.next = leaf.next;
+        right.prev = id;
+        if (leaf.next != NONE) leaves[leaf.next].prev = rightId;
+        leaf.next = rightId;
+
+        if (pos == CAPACITY && right.next == NONE) {
+            // Appending past the last entry (ascending keys): leave this leaf full
+            insertEntry(right, 0, key, row);
+        } else {
+            uint32_t mid = CAPACITY / 2;
+            for (uint32_t i = mid; i < CAPACITY; i++) {
+                right.keys[i - mid] = std::move(leaf.keys[i]);
+                right.rows[i - mid] = leaf.rows[i];
+            }
+            right.count = CAPACITY - mid;
+            leaf.count = mid;
+            if (pos <= mid) insertEntry(leaf, pos, key, row);
+            else insertEntry(right, pos - mid, key, row);
+        }
+        split.key = right.keys[0];
+        split.row = right.rows[0];
+        split.node = rightId;
+        return true;
+    }
+
+    static void insertEntry(Leaf& leaf, uint32_t pos, const Key& key, size_t row) {
+        for (uint32_t i = leaf.count; i > pos; i--) {
+            leaf.keys[i] = std::move(leaf.keys[i - 1]);
+            leaf.rows[i] = leaf.rows[i - 1];
+        }
+        leaf.keys[pos] = key;
+        leaf.rows[pos] = row;
+        leaf.count++;
+    }
+};
+
+// Ordered secondary index over one column (CREATE INDEX ... USING BTREE). Serves range
+// predicates and ORDER BY on the column. Like HashIndex, only the tree matching the column
+// type is used.
+class BTreeIndex {
+public:
+    BTreeIndex(std::string name, std::string columnName, size_t columnIdx, const DataType& type)
+        : name(std::move(name)), columnName(std::move(columnName)), columnIdx(columnIdx), type(type) {}
+
+    [[nodiscard]] const std::string& getName() const { return name; }
+    [[nodiscard]] const std::string& getColumnName() const { return columnName; }
+    [[nodiscard]] size_t getColumnIdx() const { return columnIdx; }
+
+    // Index every row currently stored in the column
+    void build(const Column& column) {
+        ints.clear();
+        floats.clear();
+        texts.clear();
+        switch (type) {
+            case DataType::INT: ints.build(column.getInts()); break;
+            case DataType::FLOAT: floats.build(column.getFloats()); break;
+            case DataType::TEXT: texts.build(column.getTexts()); break;
+        }
+    }
+
+    void insert(const Value& key, size_t rowIdx) {
+        switch (type) {
+            case DataType::INT: ints.insert(key.getInt(), rowIdx); break;
+            case DataType::FLOAT: floats.insert(key.getFloat(), rowIdx); break;
+            case DataType::TEXT: texts.insert(key.getText(), rowIdx); break;
+        }
+    }
+
+    void erase(const Value& key, size_t rowIdx) {
+        switch (type) {
+            case DataType::INT: ints.erase(key.getInt(), rowIdx); break;
+            case DataType::FLOAT: floats.erase(key.getFloat(), rowIdx); break;
+            case DataType::TEXT: texts.erase(key.getText(), rowIdx); break;
+        }
+    }
+
+    void remapRows(const std::vector<size_t>& newIds) {
+        switch (type) {
+            case DataType::INT: ints.remapRows(newIds); break;
+            case DataType::FLOAT: floats.remapRows(newIds); break;
+            case DataType::TEXT: texts.remapRows(newIds); break;
+        }
+    }
+
+    // Typed trees, only the one matching the column type is populated
+    [[nodiscard]] const BPlusTree<int64_t>& getInts() const { return ints; }
+    [[nodiscard]] const BPlusTree<double>& getFloats() const { return floats; }
+    [[nodiscard]] const BPlusTree<std::string>& getTexts() const { return texts; }
+
+private:
+    std::string name;
+    std::string columnName;
+    size_t columnIdx;
+    DataType type;
+    BPlusTree<int64_t> ints;
+    BPlusTree<double> floats;
+    BPlusTree<std::string> texts;
+};
+
+#endif //BTREEINDEX_H
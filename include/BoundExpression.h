@@ -0,0 +1,467 @@
+#ifndef BOUNDEXPRESSION_H
+#define BOUNDEXPRESSION_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <limits>
+#include "Utils.h"
+#include "Value.h"
+#include "Table.h"
+#include "Condition.h"
+#include "SimdKernels.h"
+
+// A WHERE expression compiled against one table. Binding runs once per statement:
+// column names are resolved to columns, literals are parsed into typed constants
+// and operators become enums. Evaluating a row afterwards does no allocation and
+// no string comparison other than on TEXT cells themselves.
+//
+// Scans evaluate whole batches instead: every leaf runs a comparison kernel over the
+// column's contiguous storage into a bitmap, and AND/OR nodes combine the bitmaps
+// with bitwise operations. A batch is first checked against the table's zone maps and
+// skipped if no block it spans can satisfy the expression.
+class BoundExpression {
+public:
+    static constexpr size_t BATCH_SIZE = 2048;
+    static constexpr size_t BATCH_WORDS = BATCH_SIZE / 64;
+
+    // Returns false (after reporting) if a literal cannot be converted to its column type
+    bool bind(const WhereClause& wc, const Table& table) {
+        nodes.clear();
+        root = -1;
+        boundTable = &table;
+        if (!wc.root) return true;
+        root = bindNode(wc.root.get(), table);
+        return root != -1;
+    }
+
+    [[nodiscard]] bool empty() const { return root == -1; }
+
+    // Deleted rows never match; other rows always match an empty expression
+    [[nodiscard]] bool evaluate(size_t rowIdx) const {
+        if (boundTable && boundTable->isDeleted(rowIdx)) return false;
+        return root == -1 || evaluateNode(root, rowIdx);
+    }
+
+    // Evaluates rows [begin, begin + count), count <= BATCH_SIZE, into bitmap:
+    // bit i of word i / 64 is set if row begin + i matches
+    void evaluateBatch(size_t begin, size_t count, uint64_t* bitmap) const {
+        if (root == -1) fillOnes(count, bitmap);
+        else if (!mayMatchRows(begin, count)) simd::clearBits(count, bitmap);
+        else evaluateBatchNode(root, begin, count, bitmap);
+        if (boundTable) boundTable->maskDeleted(begin, count, bitmap);
+    }
+
+    // Turns a batch bitmap into a selection vector of row ids
+    static void appendSelected(const uint64_t* bitmap, size_t begin, size_t count, std::vector<size_t>& rowIds) {
+        for (size_t w = 0; w < (count + 63) / 64; w++) {
+            uint64_t bits = bitmap[w];
+            while (bits) {
+                rowIds.push_back(begin + w * 64 + (size_t)__builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    // Uses the table's indexes to narrow down the rows the expression can match.
+    // Returns false if the whole table has to be scanned; otherwise rowIds holds an
+    // ascending superset of the matching rows (they still need to be evaluated).
+    // Equality leaves use a hash index. Comparisons on a column with a B+tree index become
+    // one range scan per column and AND group, e.g. "a > 1 AND a <= 9" scans (1, 9].
+    bool findIndexCandidates(const Table& table, std::vector<size_t>& rowIds) const {
+        return root != -1 && findIndexCandidates(root, table, rowIds);
+    }
+
+private:
+    struct Node {
+        bool isLeaf = true;
+        // Leaf: column <op> constant
+        const Column* column = nullptr; // nullptr if the column does not exist (never matches)
+        size_t columnIdx = 0;
+        CompareOp compare = CompareOp::EQ;
+        bool validOp = true;
+        int64_t intConst = 0;
+        double floatConst = 0;
+        std::string textConst;
+        // Inner node
+        LogicOp logic = LogicOp::AND;
+        int left = -1;
+        int right = -1;
+    };
+
+    std::vector<Node> nodes;
+    int root = -1;
+    const Table* boundTable = nullptr;
+
+    // A range scan that yields more than this fraction of the table is abandoned: the
+    // vectorized scan is cheaper than collecting and sorting that many row ids
+    static constexpr size_t RANGE_SCAN_FRACTION = 8;
+
+    static bool toCompareOp(const std::string& op, CompareOp& out) {
+        if (op == "=") out = CompareOp::EQ;
+        else if (op == "<>") out = CompareOp::NE;
+        else if (op == "<") out = CompareOp::LT;
+        else if (op == ">") out = CompareOp::GT;
+        else if (op == "<=") out = CompareOp::LE;
+        else if (op == ">=") out = CompareOp::GE;
+        else return false;
+        return true;
+    }
+
+    int bindNode(const ExpressionNode* expr, const Table& table) {
+        Node node;
+        if (expr->isLeaf) {
+            const Condition& cond = expr->leafCondition;
+            node.validOp = toCompareOp(cond.op, node.compare);
+
+            int colIdx = table.findColumnIndex(stripTablePrefix(cond.columnName));
+            if (colIdx != -1) {
+                node.columnIdx = (size_t)colIdx;
+                node.column = &table.getColumns()[colIdx];
+
+                // Literal takes the column's type, exactly like a stored value would. A
+                // non-integer number compared with an INT column adjusts the comparison instead.
+                DataType type = node.column->getType();
+                double number;
+                if (type == DataType::INT && !parseInt(cond.value, node.intConst) && parseFloat(cond.value, number)) {
+                    if (node.validOp) bindFractionalLiteral(number, node.compare, node.intConst);
+                    nodes.push_back(std::move(node));
+                    return (int)nodes.size() - 1;
+                }
+                try {
+                    Value constant(type, type == DataType::TEXT ? stripQuotes(cond.value) : cond.value);
+                    switch (type) {
+                        case DataType::INT: node.intConst = constant.getInt(); break;
+                        case DataType::FLOAT: node.floatConst = constant.getFloat(); break;
+                        case DataType::TEXT: node.textConst = constant.getText(); break;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid literal in WHERE clause for column " << cond.columnName << ": " << cond.value << "\n";
+                    return -1;
+                }
+            }
+        } else {
+            node.isLeaf = false;
+            if (expr->op == "AND") node.logic = LogicOp::AND;
+            else if (expr->op == "OR") node.logic = LogicOp::OR;
+            else node.validOp = false;
+
+            node.left = bindNode(expr->left.get(), table);
+            if (node.left == -1) return -1;
+            node.right = bindNode(expr->right.get(), table);
+            if (node.right == -1) return -1;
+        }
+        nodes.push_back(std::move(node));
+        return (int)nodes.size() - 1;
+    }
+
+    // An INT column compared with a number written as a float: the comparison is rewritten
+    // into an equivalent one on an integer bound, e.g. "= 30.0" into "= 30", "> 30.5" into
+    // "> 30" and "< 30.5" into "< 31". "= 30.5" matches nothing and "<> 30.5" everything;
+    // a NaN literal satisfies only <>, <= and >=, as it does against a FLOAT column.
+    // Always-false becomes "< INT64_MIN", always-true ">= INT64_MIN".
+    static void bindFractionalLiteral(double literal, CompareOp& op, int64_t& constant) {
+        constexpr double LIMIT = 9223372036854775808.0; // 2^63
+        bool matches = false;
+        if (std::isnan(literal)) {
+            matches = op == CompareOp::NE || op == CompareOp::LE || op == CompareOp::GE;
+        } else if (literal >= LIMIT || literal < -LIMIT) {
+            // Beyond every INT value (-2^63 itself is the integer INT64_MIN and parses as one)
+            bool above = literal > 0;
+            switch (op) {
+                case CompareOp::EQ: matches = false; break;
+                case CompareOp::NE: matches = true; break;
+                case CompareOp::LT: case CompareOp::LE: matches = above; break;
+                default: matches = !above; break;
+            }
+        } else if (literal == std::floor(literal)) {
+            constant = (int64_t)literal; // e.g. 30.0 or 3e1
+            return;
+        } else {
+            switch (op) {
+                case CompareOp::EQ: matches = false; break;
+                case CompareOp::NE: matches = true; break;
+                case CompareOp::LT: case CompareOp::GE: constant = (int64_t)std::ceil(literal); return;
+                case CompareOp::GT: case CompareOp::LE: constant = (int64_t)std::floor(literal); return;
+            }
+        }
+        op = matches ? CompareOp::GE : CompareOp::LT;
+        constant = INT64_MIN;
+    }
+
+    template <typename T>
+    static bool compareCell(const T& cell, const T& constant, CompareOp op) {
+        switch (op) {
+            case CompareOp::EQ: return cell == constant;
+            case CompareOp::NE: return !(cell == constant);
+            case CompareOp::LT: return cell < constant;
+            case CompareOp::GT: return cell > constant;
+            case CompareOp::LE: return !(cell > constant);
+            case CompareOp::GE: return !(cell < constant);
+        }
+        return false;
+    }
+
+    // False if the zone maps rule out a match for every row in [begin, begin + count)
+    bool mayMatchRows(size_t begin, size_t count) const {
+        if (!boundTable) return true;
+        for (size_t block = begin / ZoneMap::BLOCK_SIZE; block * ZoneMap::BLOCK_SIZE < begin + count; block++) {
+            if (blockMayMatch(root, block)) return true;
+        }
+        return false;
+    }
+
+    bool blockMayMatch(int idx, size_t block) const {
+        const Node& node = nodes[idx];
+        if (!node.validOp) return false;
+
+        if (node.isLeaf) {
+            if (!node.column) return false;
+            const ZoneMap& zones = boundTable->getZoneMap(node.columnIdx);
+            if (block >= zones.blockCount()) return true;
+            switch (node.column->getType()) {
+                case DataType::INT: return zones.mayMatch(block, node.compare, node.intConst);
+                case DataType::FLOAT: return zones.mayMatch(block, node.compare, node.floatConst);
+                case DataType::TEXT: return zones.mayMatch(block, node.compare, node.textConst);
+            }
+            return true;
+        }
+
+        bool left = blockMayMatch(node.left, block);
+        if (node.logic == LogicOp::AND) return left && blockMayMatch(node.right, block);
+        return left || blockMayMatch(node.right, block);
+    }
+
+    bool evaluateNode(int idx, size_t rowIdx) const {
+        const Node& node = nodes[idx];
+        if (!node.validOp) return false;
+
+        if (node.isLeaf) {
+            if (!node.column) return false;
+            switch (node.column->getType()) {
+                case DataType::INT: return compareCell(node.column->getInts()[rowIdx], node.intConst, node.compare);
+                case DataType::FLOAT: return compareCell(node.column->getFloats()[rowIdx], node.floatConst, node.compare);
+                case DataType::TEXT: return compareCell(node.column->getTexts()[rowIdx], node.textConst, node.compare);
+            }
+            return false;
+        }
+
+        bool leftVal = evaluateNode(node.left, rowIdx);
+        bool rightVal = evaluateNode(node.right, rowIdx);
+        return node.logic == LogicOp::AND ? (leftVal && rightVal) : (leftVal || rightVal);
+    }
+
+    static void fillOnes(size_t count, uint64_t* bitmap) {
+        size_t words = (count + 63) / 64;
+        for (size_t w = 0; w < words; w++) bitmap[w] = ~uint64_t(0);
+        if (count % 64) bitmap[words - 1] = (uint64_t(1) << (count % 64)) - 1;
+    }
+
+    void evaluateBatchNode(int idx, size_t begin, size_t count, uint64_t* bitmap) const {
+        const Node& node = nodes[idx];
+        size_t words = (count + 63) / 64;
+        if (!node.validOp || (node.isLeaf && !node.column)) {
+            simd::clearBits(count, bitmap);
+            return;
+        }
+
+        if (node.isLeaf) {
+            switch (node.column->getType()) {
+                case DataType::INT:
+                    simd::compareInt64(node.column->getInts().data() + begin, count, node.intConst, node.compare, bitmap);
+                    break;
+                case DataType::FLOAT:
+                    simd::compareDouble(node.column->getFloats().data() + begin, count, node.floatConst, node.compare, bitmap);
+                    break;
+                case DataType::TEXT: {
+                    simd::clearBits(count, bitmap);
+                    const std::string* texts = node.column->getTexts().data() + begin;
+                    for (size_t i = 0; i < count; i++) {
+                        if (compareCell(texts[i], node.textConst, node.compare)) bitmap[i / 64] |= uint64_t(1) << (i % 64);
+                    }
+                    break;
+                }
+            }
+            return;
+        }
+
+        evaluateBatchNode(node.left, begin, count, bitmap);
+
+        // AND with an empty left side cannot match anything
+        if (node.logic == LogicOp::AND) {
+            uint64_t any = 0;
+            for (size_t w = 0; w < words; w++) any |= bitmap[w];
+            if (!any) return;
+        }
+
+        uint64_t rightBits[BATCH_WORDS];
+        evaluateBatchNode(node.right, begin, count, rightBits);
+        if (node.logic == LogicOp::AND) {
+            for (size_t w = 0; w < words; w++) bitmap[w] &= rightBits[w];
+        } else {
+            for (size_t w = 0; w < words; w++) bitmap[w] |= rightBits[w];
+        }
+    }
+
+    bool findIndexCandidates(int idx, const Table& table, std::vector<size_t>& rowIds) const {
+        const Node& node = nodes[idx];
+        if (!node.validOp) return false;
+
+        if (node.isLeaf) {
+            return hashCandidates(node, table, rowIds) || rangeCandidates(table, {idx}, rowIds);
+        }
+        if (node.logic == LogicOp::AND) return conjunctionCandidates(idx, table, rowIds);
+
+        std::vector<size_t> leftIds, rightIds;
+        if (!findIndexCandidates(node.left, table, leftIds) || !findIndexCandidates(node.right, table, rightIds)) {
+            return false;
+        }
+        std::set_union(leftIds.begin(), leftIds.end(), rightIds.begin(), rightIds.end(), std::back_inserter(rowIds));
+        return true;
+    }
+
+    // Children of a chain of AND nodes
+    void collectConjuncts(int idx, std::vector<int>& conjuncts) const {
+        const Node& node = nodes[idx];
+        if (!node.isLeaf && node.validOp && node.logic == LogicOp::AND) {
+            collectConjuncts(node.left, conjuncts);
+            collectConjuncts(node.right, conjuncts);
+        } else {
+            conjuncts.push_back(idx);
+        }
+    }
+
+    // Intersects the candidates of every conjunct that can use an index
+    bool conjunctionCandidates(int idx, const Table& table, std::vector<size_t>& rowIds) const {
+        std::vector<int> conjuncts;
+        collectConjuncts(idx, conjuncts);
+
+        std::vector<std::vector<size_t>> sets;
+        std::vector<int> rangeLeaves;
+        for (int c : conjuncts) {
+            const Node& node = nodes[c];
+            std::vector<size_t> ids;
+            if (node.isLeaf && hashCandidates(node, table, ids)) {
+                sets.push_back(std::move(ids));
+            } else if (node.isLeaf) {
+                if (node.validOp && node.column && node.compare != CompareOp::NE) rangeLeaves.push_back(c);
+            } else if (findIndexCandidates(c, table, ids)) {
+                sets.push_back(std::move(ids));
+            }
+        }
+
+        // Comparisons on the same column are merged into a single range
+        std::vector<bool> merged(rangeLeaves.size(), false);
+        for (size_t i = 0; i < rangeLeaves.size(); i++) {
+            if (merged[i]) continue;
+            std::vector<int> sameColumn;
+            for (size_t j = i; j < rangeLeaves.size(); j++) {
+                if (nodes[rangeLeaves[j]].columnIdx == nodes[rangeLeaves[i]].columnIdx) {
+                    sameColumn.push_back(rangeLeaves[j]);
+                    merged[j] = true;
+                }
+            }
+            std::vector<size_t> ids;
+            if (rangeCandidates(table, sameColumn, ids)) sets.push_back(std::move(ids));
+        }
+
+        if (sets.empty()) return false;
+        std::sort(sets.begin(), sets.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+        rowIds = std::move(sets[0]);
+        for (size_t i = 1; i < sets.size() && !rowIds.empty(); i++) {
+            std::vector<size_t> both;
+            std::set_intersection(rowIds.begin(), rowIds.end(), sets[i].begin(), sets[i].end(), std::back_inserter(both));
+            rowIds = std::move(both);
+        }
+        return true;
+    }
+
+    // Equality leaf on a column with a hash index
+    bool hashCandidates(const Node& node, const Table& table, std::vector<size_t>& rowIds) const {
+        if (!node.validOp || !node.column || node.compare != CompareOp::EQ) return false;
+        const HashIndex* index = table.getIndexOnColumn(node.columnIdx);
+        if (!index) return false;
+
+        const std::vector<size_t>* ids = nullptr;
+        switch (node.column->getType()) {
+            case DataType::INT: ids = index->lookup(Value(node.intConst)); break;
+            case DataType::FLOAT: ids = index->lookup(Value(node.floatConst)); break;
+            case DataType::TEXT: ids = index->lookup(Value(DataType::TEXT, node.textConst)); break;
+        }
+        rowIds = ids ? *ids : std::vector<size_t>{};
+        return true;
+    }
+
+    // Comparison leaves on one column with a B+tree index, scanned as a single range
+    bool rangeCandidates(const Table& table, const std::vector<int>& leaves, std::vector<size_t>& rowIds) const {
+        const Node& first = nodes[leaves[0]];
+        if (!first.validOp || !first.column || first.compare == CompareOp::NE) return false;
+        const BTreeIndex* index = table.getOrderedIndexOnColumn(first.columnIdx);
+        if (!index) return false;
+
+        size_t maxRows = table.rowCount() / RANGE_SCAN_FRACTION;
+        switch (first.column->getType()) {
+            case DataType::INT: return scanRange(index->getInts(), leaves, &Node::intConst, maxRows, rowIds);
+            case DataType::FLOAT: return scanRange(index->getFloats(), leaves, &Node::floatConst, maxRows, rowIds);
+            case DataType::TEXT: return scanRange(index->getTexts(), leaves, &Node::textConst, maxRows, rowIds);
+        }
+        return false;
+    }
+
+    // A FLOAT comparison <= or >= is "not greater"/"not less", so it holds for NaN cells and,
+    // with a NaN constant, for every cell. NaN keys sort last in the tree: a range bounded
+    // above stops before them and they are scanned separately when every leaf admits them.
+    template <typename Key>
+    bool scanRange(const BPlusTree<Key>& tree, const std::vector<int>& leaves, Key Node::*constant, size_t maxRows,
+                   std::vector<size_t>& rowIds) const {
+        KeyRange<Key> range;
+        bool nanCells = true;
+        for (int leaf : leaves) {
+            CompareOp op = nodes[leaf].compare;
+            bool admitsNan = op == CompareOp::LE || op == CompareOp::GE;
+            if (!admitsNan) nanCells = false;
+            if (isNanKey(nodes[leaf].*constant)) {
+                if (admitsNan) continue;
+                rowIds.clear(); // =, <, > against NaN match nothing
+                return true;
+            }
+            range.restrict(op, nodes[leaf].*constant);
+        }
+
+        bool complete = true;
+        auto collect = [&](size_t rowIdx) {
+            if (rowIds.size() == maxRows) {
+                complete = false;
+                return false;
+            }
+            rowIds.push_back(rowIdx);
+            return true;
+        };
+        tree.scan(range, collect);
+        KeyRange<Key> nanTail;
+        if (complete && nanCells && range.hasHigh && nanKeys(nanTail)) tree.scan(nanTail, collect);
+        if (!complete) {
+            rowIds.clear();
+            return false;
+        }
+        std::sort(rowIds.begin(), rowIds.end());
+        return true;
+    }
+
+    template <typename Key>
+    static bool isNanKey(const Key&) { return false; }
+    static bool isNanKey(double key) { return std::isnan(key); }
+
+    // Range of the NaN keys; false for key types without NaN
+    template <typename Key>
+    static bool nanKeys(KeyRange<Key>&) { return false; }
+    static bool nanKeys(KeyRange<double>& range) {
+        return range.restrict(CompareOp::GE, std::numeric_limits<double>::quiet_NaN());
+    }
+};
+
+#endif //BOUNDEXPRESSION_H
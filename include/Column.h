@@ -7,55 +7,157 @@
 
 
 #include <vector>
-#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <iostream>
 #include "Utils.h"
 #include "Value.h"
 
+// Columnar storage: each column owns one contiguous vector of its native type.
+// Only the vector matching `type` is used; a row id is simply an offset into it.
 class Column {
 public:
     Column(std::string title, const DataType& type): type(type), title(std::move(title)) {};
 
     [[nodiscard]] std::string getTitle() const {return title;}
 
-    [[nodiscard]] bool addValue(std::shared_ptr<Value> value) {
-        if (value->getType() != type) {
+    [[nodiscard]] size_t size() const {
+        switch (type) {
+            case DataType::INT: return ints.size();
+            case DataType::FLOAT: return floats.size();
+            default: return texts.size();
+        }
+    }
+
+    [[nodiscard]] bool addValue(const Value& value) {
+        if (value.getType() != type) {
             std::cerr << "type not match when adding value to column " << this->title << std::endl;
             return false;
         }
-        values.push_back(std::move(value));
+        switch (type) {
+            case DataType::INT: ints.push_back(value.getInt()); break;
+            case DataType::FLOAT: floats.push_back(value.getFloat()); break;
+            case DataType::TEXT: texts.push_back(value.getText()); break;
+        }
         return true;
     }
 
-    // Remove the value at the given index
-    bool removeValueAt(size_t index) {
-        if (index >= values.size()) {
-            std::cerr << "Index out of range in removeValueAt for column " << title << "\n";
-            return false;
+    // Drop rows in one pass: row i moves to newIds[i], rows mapped to SIZE_MAX are removed.
+    // newIds must be increasing over the kept rows, with `kept` of them.
+    void compact(const std::vector<size_t>& newIds, size_t kept) {
+        auto sweep = [&newIds, kept](auto& values) {
+            for (size_t i = 0; i < values.size(); i++) {
+                if (newIds[i] != SIZE_MAX && newIds[i] != i) values[newIds[i]] = std::move(values[i]);
+            }
+            values.resize(kept);
+        };
+        switch (type) {
+            case DataType::INT: sweep(ints); break;
+            case DataType::FLOAT: sweep(floats); break;
+            case DataType::TEXT: sweep(texts); break;
         }
-        values.erase(values.begin() + index);
-        return true;
     }
 
     // Update the value at the given index
-    bool updateValueAt(size_t index, std::shared_ptr<Value> newValue) {
-        if (index >= values.size()) {
+    bool updateValueAt(size_t index, const Value& newValue) {
+        if (index >= size()) {
             std::cerr << "Index out of range in updateValueAt for column " << title << "\n";
             return false;
         }
-        if (newValue->getType() != type) {
+        if (newValue.getType() != type) {
             std::cerr << "Type mismatch in updateValueAt for column " << title << "\n";
             return false;
         }
-        values[index] = std::move(newValue);
+        switch (type) {
+            case DataType::INT: ints[index] = newValue.getInt(); break;
+            case DataType::FLOAT: floats[index] = newValue.getFloat(); break;
+            case DataType::TEXT: texts[index] = newValue.getText(); break;
+        }
         return true;
     }
 
+    // Materialize the cell at the given index as a Value
+    [[nodiscard]] Value getValue(size_t index) const {
+        switch (type) {
+            case DataType::INT: return Value(ints[index]);
+            case DataType::FLOAT: return Value(floats[index]);
+            default: return Value(DataType::TEXT, texts[index]);
+        }
+    }
+
+    // Parse a raw literal straight into the column; malformed numbers become placeholders
+    void appendRaw(std::string_view raw) {
+        switch (type) {
+            case DataType::INT: {
+                int64_t parsed;
+                ints.push_back(parseInt(raw, parsed) ? parsed : INT_PLACEHOLDER);
+                break;
+            }
+            case DataType::FLOAT: {
+                double parsed;
+                floats.push_back(parseFloat(raw, parsed) ? parsed : FLOAT_PLACEHOLDER);
+                break;
+            }
+            case DataType::TEXT: texts.emplace_back(raw); break;
+        }
+    }
+
+    // Move all values of another column of the same type onto the end of this one
+    void append(Column&& other) {
+        reserveAdditional(other.size());
+        switch (type) {
+            case DataType::INT: ints.insert(ints.end(), other.ints.begin(), other.ints.end()); break;
+            case DataType::FLOAT: floats.insert(floats.end(), other.floats.begin(), other.floats.end()); break;
+            case DataType::TEXT:
+                texts.insert(texts.end(), std::make_move_iterator(other.texts.begin()), std::make_move_iterator(other.texts.end()));
+                break;
+        }
+        other = Column(other.title, other.type);
+    }
+
+    // Make room for `extra` more values, growing geometrically so repeated small
+    // batches stay amortized O(1) per value
+    void reserveAdditional(size_t extra) {
+        auto grow = [extra](auto& values) {
+            size_t needed = values.size() + extra;
+            if (needed > values.capacity()) values.reserve(std::max(needed, values.capacity() * 2));
+        };
+        switch (type) {
+            case DataType::INT: grow(ints); break;
+            case DataType::FLOAT: grow(floats); break;
+            case DataType::TEXT: grow(texts); break;
+        }
+    }
+
+    void reserve(size_t n) {
+        switch (type) {
+            case DataType::INT: ints.reserve(n); break;
+            case DataType::FLOAT: floats.reserve(n); break;
+            case DataType::TEXT: texts.reserve(n); break;
+        }
+    }
+
+    // Replace the whole storage at once, e.g. with a segment read from a data file.
+    // Only the overload matching the column type may be used.
+    void assign(std::vector<int64_t> values) { ints = std::move(values); }
+    void assign(std::vector<double> values) { floats = std::move(values); }
+    void assign(std::vector<std::string> values) { texts = std::move(values); }
+
+    // Direct access to the contiguous storage for scans
+    [[nodiscard]] const std::vector<int64_t>& getInts() const { return ints; }
+    [[nodiscard]] const std::vector<double>& getFloats() const { return floats; }
+    [[nodiscard]] const std::vector<std::string>& getTexts() const { return texts; }
+
     [[nodiscard]] DataType getType() const { return type; }
 
 private:
     DataType type;
     std::string title;
-    std::vector<std::shared_ptr<Value>> values;
+    std::vector<int64_t> ints;
+    std::vector<double> floats;
+    std::vector<std::string> texts;
 };
 
 
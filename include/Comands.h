@@ -6,7 +6,9 @@
 #define COMANDS_H
 
 #include <string>
+#include <cstdint>
 #include "Utils.h"
+#include "Condition.h"
 #include <vector>
 
 
@@ -96,10 +98,61 @@ private:
 };
 
 
+class SetDurabilityCommand : public Command {
+public:
+  explicit SetDurabilityCommand(const std::string& mode) : mode(mode) {}
+
+  std::string getType() const override {
+    return "SET_DURABILITY";
+  }
+
+  const std::string& getMode() const {
+    return mode;
+  }
+
+private:
+  std::string mode;  // lower case: sync, group or off
+};
+
+class CreateIndexCommand : public Command {
+public:
+  CreateIndexCommand(const std::string& idxName, const std::string& tblName, const std::string& colName,
+                     IndexKind kind = IndexKind::HASH)
+      : indexName(idxName), tableName(tblName), columnName(colName), kind(kind) {}
+
+  std::string getType() const override {
+    return "CREATE_INDEX";
+  }
+
+  const std::string& getIndexName() const {
+    return indexName;
+  }
+
+  const std::string& getTableName() const {
+    return tableName;
+  }
+
+  const std::string& getColumnName() const {
+    return columnName;
+  }
+
+  IndexKind getKind() const {
+    return kind;
+  }
+
+private:
+  std::string indexName;
+  std::string tableName;
+  std::string columnName;
+  IndexKind kind;
+};
+
+
 class InsertCommand : public Command {
 public:
-  InsertCommand(const std::string& tblName, const std::vector<std::string>& vals)
-      : tableName(tblName), values(vals) {}
+  // One entry per VALUES tuple
+  InsertCommand(const std::string& tblName, std::vector<std::vector<std::string>> rows)
+      : tableName(tblName), rows(std::move(rows)) {}
 
   std::string getType() const override {
     return "INSERT";
@@ -109,13 +162,41 @@ public:
     return tableName;
   }
 
-  const std::vector<std::string>& getValues() const {
-    return values;
+  const std::vector<std::vector<std::string>>& getRows() const {
+    return rows;
+  }
+
+private:
+  std::string tableName;
+  std::vector<std::vector<std::string>> rows;
+};
+
+class CopyCommand : public Command {
+public:
+  CopyCommand(const std::string& tblName, const std::string& path, bool header)
+      : tableName(tblName), path(path), header(header) {}
+
+  std::string getType() const override {
+    return "COPY";
+  }
+
+  const std::string& getTableName() const {
+    return tableName;
+  }
+
+  const std::string& getPath() const {
+    return path;
+  }
+
+  // Whether the first line of the file holds column names and is skipped
+  bool hasHeader() const {
+    return header;
   }
 
 private:
   std::string tableName;
-  std::vector<std::string> values;
+  std::string path;
+  bool header;
 };
 
 
@@ -124,14 +205,31 @@ public:
   struct JoinClause {
     std::string joinType;    // e.g., "INNER JOIN"
     std::string tableName;
-    std::string condition;
+    std::string condition;   // "left.column = right.column"
+  };
+
+  // One entry per select column when the select list contains aggregates
+  struct Aggregate {
+    std::string function;  // COUNT, SUM, AVG, MIN, MAX; empty for a plain column
+    std::string column;    // argument column, "*" for COUNT(*)
+  };
+
+  struct OrderKey {
+    std::string column;
+    bool descending;
   };
 
   SelectCommand(const std::vector<std::string>& cols,
                 const std::string& tblName,
-                const std::string& whereClause = "",
-                const std::vector<JoinClause>& joins = {})
-      : columns(cols), tableName(tblName), where(whereClause), joins(joins) {}
+                WhereClause whereClause = {},
+                const std::vector<JoinClause>& joins = {},
+                const std::vector<std::string>& groupBy = {},
+                const std::vector<Aggregate>& aggregates = {},
+                const std::vector<OrderKey>& orderBy = {},
+                int64_t limit = -1,
+                size_t offset = 0)
+      : columns(cols), tableName(tblName), where(std::move(whereClause)), joins(joins),
+        groupBy(groupBy), aggregates(aggregates), orderBy(orderBy), limit(limit), offset(offset) {}
 
   std::string getType() const override {
     return "SELECT";
@@ -139,14 +237,28 @@ public:
 
   const std::vector<std::string>& getColumns() const { return columns; }
   const std::string& getTableName() const { return tableName; }
-  const std::string& getWhereClause() const { return where; }
+  const WhereClause& getWhereClause() const { return where; }
   const std::vector<JoinClause>& getJoins() const { return joins; }
+  const std::vector<std::string>& getGroupBy() const { return groupBy; }
+  const std::vector<Aggregate>& getAggregates() const { return aggregates; }
+
+  const std::vector<OrderKey>& getOrderBy() const { return orderBy; }
+  int64_t getLimit() const { return limit; }  // -1 if there is no LIMIT
+  size_t getOffset() const { return offset; }
+
+  bool isAggregation() const { return !aggregates.empty() || !groupBy.empty(); }
+  bool hasLimit() const { return limit >= 0; }
 
 private:
   std::vector<std::string> columns;
   std::string tableName;
-  std::string where;
+  WhereClause where;
   std::vector<JoinClause> joins;
+  std::vector<std::string> groupBy;
+  std::vector<Aggregate> aggregates;
+  std::vector<OrderKey> orderBy;
+  int64_t limit;
+  size_t offset;
 };
 
 
@@ -154,8 +266,8 @@ class UpdateCommand : public Command {
 public:
   UpdateCommand(const std::string& tblName,
                 const std::vector<std::pair<std::string, std::string>>& updates,
-                const std::string& whereClause = "")
-      : tableName(tblName), setClauses(updates), where(whereClause) {}
+                WhereClause whereClause = {})
+      : tableName(tblName), setClauses(updates), where(std::move(whereClause)) {}
 
   std::string getType() const override {
     return "UPDATE";
@@ -169,21 +281,21 @@ public:
     return setClauses;
   }
 
-  const std::string& getWhereClause() const {
+  const WhereClause& getWhereClause() const {
     return where;
   }
 
 private:
   std::string tableName;
   std::vector<std::pair<std::string, std::string>> setClauses;
-  std::string where;
+  WhereClause where;
 };
 
 
 class DeleteCommand : public Command {
 public:
-  DeleteCommand(const std::string& tblName, const std::string& whereClause = "")
-      : tableName(tblName), where(whereClause) {}
+  DeleteCommand(const std::string& tblName, WhereClause whereClause = {})
+      : tableName(tblName), where(std::move(whereClause)) {}
 
   std::string getType() const override {
     return "DELETE";
@@ -193,13 +305,32 @@ public:
     return tableName;
   }
 
-  const std::string& getWhereClause() const {
+  const WhereClause& getWhereClause() const {
     return where;
   }
 
 private:
   std::string tableName;
-  std::string where;
+  WhereClause where;
+};
+
+
+// Drops deleted rows from one table, or from every table of the database if no name is given
+class VacuumCommand : public Command {
+public:
+  explicit VacuumCommand(const std::string& tblName = "")
+      : tableName(tblName) {}
+
+  std::string getType() const override {
+    return "VACUUM";
+  }
+
+  const std::string& getTableName() const {
+    return tableName;
+  }
+
+private:
+  std::string tableName;
 };
 
 
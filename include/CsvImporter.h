@@ -0,0 +1,209 @@
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Table.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+
+// Parallel bulk import of RFC 4180 style CSV (COPY): fields are separated by ',', may be
+// wrapped in double quotes (which can then contain ',', line breaks and "" for a literal
+// quote), records end with LF or CRLF, and blank lines are skipped.
+//
+// The file is memory-mapped and cut into chunks of about CHUNK_BYTES that end on record
+// boundaries; finding them only takes a quote-parity pass (memchr for '"') over the file.
+// The pool parses and type-converts chunks into per-chunk column buffers, which are then
+// appended to the table in file order. Chunks are processed in waves of a few per thread,
+// so only one wave of parsed data is buffered at a time.
+class CsvImporter {
+public:
+    static constexpr size_t CHUNK_BYTES = 4 << 20;
+
+    // Append the records of `path` to `table`. A record with the wrong number of fields
+    // stops the import: the records before it are kept, and false is returned.
+    static bool import(const std::string& path, Table& table, bool header, ThreadPool& pool, size_t& rowsImported) {
+        rowsImported = 0;
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "Failed to open " << path << "\n";
+            return false;
+        }
+        const char* data = file.data();
+        size_t size = file.size();
+        if (size == 0) return true;
+
+        size_t begin = 0;
+        size_t line = 1; // line on which the current chunk starts
+        if (header) {
+            begin = skipRecord(data, size, 0);
+            line += countLines(data, 0, begin);
+        }
+        std::vector<size_t> bounds = findChunkBounds(data, size, begin);
+        size_t numChunks = bounds.size() - 1;
+
+        std::vector<std::pair<std::string, DataType>> schema;
+        for (const auto& column : table.getColumns()) schema.emplace_back(column.getTitle(), column.getType());
+
+        size_t waveSize = pool.size() * 4;
+        for (size_t first = 0; first < numChunks; first += waveSize) {
+            size_t wave = std::min(waveSize, numChunks - first);
+            std::vector<Chunk> chunks(wave);
+            pool.parallelFor(wave, [&](size_t w) {
+                parseChunk(data, bounds[first + w], bounds[first + w + 1], schema, chunks[w]);
+            });
+
+            for (auto& chunk : chunks) {
+                size_t rows = chunk.columns.empty() ? 0 : chunk.columns[0].size();
+                if (rows > 0 && !table.appendColumns(chunk.columns)) return false;
+                rowsImported += rows;
+                if (chunk.errorLine != 0) {
+                    std::cerr << "COPY " << table.getName() << ": line " << line + chunk.errorLine - 1 << " has "
+                              << chunk.errorFields << " fields, expected " << schema.size() << "\n";
+                    return false;
+                }
+                line += chunk.lines;
+            }
+        }
+        return true;
+    }
+
+private:
+    // Parsed contents of one chunk
+    struct Chunk {
+        std::vector<Column> columns;
+        size_t lines = 0;       // line breaks in the chunk
+        size_t errorLine = 0;   // chunk-relative line of the first malformed record, 0 if none
+        size_t errorFields = 0; // number of fields that record had
+    };
+
+    static size_t countLines(const char* data, size_t begin, size_t end) {
+        size_t lines = 0;
+        for (const char* p = data + begin; (p = static_cast<const char*>(std::memchr(p, '\n', data + end - p))); p++) lines++;
+        return lines;
+    }
+
+    // Offset just past the record starting at pos
+    static size_t skipRecord(const char* data, size_t size, size_t pos) {
+        bool inQuotes = false;
+        while (pos < size) {
+            char c = data[pos++];
+            if (c == '"') inQuotes = !inQuotes;
+            else if (c == '\n' && !inQuotes) break;
+        }
+        return pos;
+    }
+
+    // Chunk start offsets plus the end of the file. Quote parity is tracked from the start
+    // so that a line break inside a quoted field never ends a chunk.
+    static std::vector<size_t> findChunkBounds(const char* data, size_t size, size_t begin) {
+        std::vector<size_t> bounds{begin};
+        size_t pos = begin;
+        bool inQuotes = false;
+        while (size - bounds.back() > CHUNK_BYTES) {
+            size_t target = bounds.back() + CHUNK_BYTES;
+            while (pos < target) {
+                auto quote = static_cast<const char*>(std::memchr(data + pos, '"', target - pos));
+                if (!quote) {
+                    pos = target;
+                    break;
+                }
+                inQuotes = !inQuotes;
+                pos = quote - data + 1;
+            }
+            while (pos < size) {
+                char c = data[pos++];
+                if (c == '"') inQuotes = !inQuotes;
+                else if (c == '\n' && !inQuotes) break;
+            }
+            if (pos >= size) break;
+            bounds.push_back(pos);
+        }
+        bounds.push_back(size);
+        return bounds;
+    }
+
+    static void parseChunk(const char* data, size_t begin, size_t end,
+                           const std::vector<std::pair<std::string, DataType>>& schema, Chunk& chunk) {
+        for (const auto& config : schema) chunk.columns.emplace_back(config.first, config.second);
+        std::vector<std::string_view> fields;
+        std::deque<std::string> unescaped; // storage for quoted fields, stable while a record is parsed
+
+        size_t pos = begin;
+        while (pos < end) {
+            size_t recordLine = chunk.lines + 1;
+            if (data[pos] == '\n' || (data[pos] == '\r' && pos + 1 < end && data[pos + 1] == '\n')) {
+                pos += data[pos] == '\n' ? 1 : 2;
+                chunk.lines++;
+                continue;
+            }
+
+            fields.clear();
+            unescaped.clear();
+            bool endOfRecord = false;
+            while (!endOfRecord) {
+                size_t fieldStart = pos;
+                while (pos < end && data[pos] != ',' && data[pos] != '\n' && data[pos] != '"') pos++;
+                if (pos == end || data[pos] != '"') {
+                    // Unquoted field: a view straight into the mapping
+                    size_t fieldEnd = pos;
+                    if (pos < end && data[pos] == '\n' && fieldEnd > fieldStart && data[fieldEnd - 1] == '\r') fieldEnd--;
+                    fields.emplace_back(data + fieldStart, fieldEnd - fieldStart);
+                } else {
+                    fields.push_back(parseQuotedField(data, fieldStart, pos, end, chunk.lines, unescaped));
+                }
+                if (pos == end || data[pos] == '\n') endOfRecord = true;
+                pos++; // past ',' or '\n'
+            }
+            if (pos <= end) chunk.lines++;
+
+            if (fields.size() != schema.size()) {
+                chunk.errorLine = recordLine;
+                chunk.errorFields = fields.size();
+                return;
+            }
+            for (size_t c = 0; c < fields.size(); c++) chunk.columns[c].appendRaw(fields[c]);
+        }
+    }
+
+    // Field containing quotes, starting at fieldStart; pos is at its first '"'. Leaves pos
+    // on the ',' or '\n' that ends the field (or at end).
+    static std::string_view parseQuotedField(const char* data, size_t fieldStart, size_t& pos, size_t end,
+                                             size_t& lines, std::deque<std::string>& unescaped) {
+        std::string& field = unescaped.emplace_back(data + fieldStart, pos - fieldStart);
+        bool inQuotes = false;
+        for (; pos < end; pos++) {
+            char c = data[pos];
+            if (inQuotes) {
+                if (c == '"') {
+                    if (pos + 1 < end && data[pos + 1] == '"') {
+                        field += '"';
+                        pos++;
+                    } else {
+                        inQuotes = false;
+                    }
+                } else if (c == '\n') {
+                    if (!field.empty() && field.back() == '\r') field.pop_back();
+                    field += '\n';
+                    lines++;
+                } else {
+                    field += c;
+                }
+            } else if (c == '"') {
+                inQuotes = true;
+            } else if (c == ',' || c == '\n') {
+                break;
+            } else {
+                field += c;
+            }
+        }
+        if (pos < end && data[pos] == '\n' && !field.empty() && field.back() == '\r') field.pop_back();
+        return field;
+    }
+};
+
+#endif //CSVIMPORTER_H
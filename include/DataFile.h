@@ -0,0 +1,592 @@
+#ifndef DATAFILE_H
+#define DATAFILE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "Utils.h"
+#include "Table.h"
+#include "WriteAheadLog.h"
+#include "MappedFile.h"
+
+#include <iterator>
+
+// Binary table storage. A database is a small manifest (./databases/<name>.db) naming one
+// data file per table in ./databases/<name>/. A data file is laid out as
+//   [header, 64 bytes][column segments][directory]
+// Every column segment starts on a page boundary and stores the column as a fixed-width
+// array in host byte order: int64 for INT, double for FLOAT, and for TEXT (rows + 1) u64
+// offsets into a string heap that directly follows them. Each column segment is followed by a page-aligned zone map segment (see ZoneMap) holding per block
+// [min][max] as int64 for INT, [min][max][NaN count] as double, double, u64 for FLOAT, and
+// for TEXT (2 * blocks + 1) u64 offsets into a heap of the min, max strings of each block.
+// The directory lists each table's schema, row count, zone map block size, segment
+// locations and index definitions (name, column, kind).
+// The header points to the directory and carries checksums for itself and the directory,
+// so opening a file only validates those; column data is copied out of the mapping
+// without any parsing.
+class DataFile {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MANIFEST_VERSION = 1;
+    static constexpr uint64_t PAGE_SIZE = 4096;
+
+    struct ColumnEntry {
+        std::string name;
+        DataType type;
+        uint64_t offset; // segment position in the file
+        uint64_t size;   // segment length in bytes
+        uint64_t zoneOffset = 0;
+        uint64_t zoneSize = 0; // 0 for an empty INT or FLOAT column
+    };
+
+    struct IndexEntry {
+        std::string name;
+        std::string columnName;
+        IndexKind kind = IndexKind::HASH;
+    };
+
+    struct TableEntry {
+        std::string name;
+        uint64_t rowCount;
+        uint32_t zoneBlockSize = 0; // rows per zone map block
+        std::vector<ColumnEntry> columns;
+        std::vector<IndexEntry> indexes;
+    };
+
+    // A database's catalog: which file holds each table. Written last by a checkpoint,
+    // so replacing it is what makes the newly written table files current.
+    struct Manifest {
+        struct Entry {
+            std::string tableName;
+            std::string fileName; // relative to the database's table directory
+            uint64_t rowCount = 0;
+            std::vector<std::string> indexNames;
+        };
+
+        std::string databaseName;
+        uint64_t checkpointLsn = 0;
+        uint64_t nextFileId = 0; // table files are never overwritten, each gets a fresh id
+        std::vector<Entry> tables;
+    };
+
+    // True if the file exists and starts with the manifest's magic
+    static bool isManifest(const std::string& path) {
+        return hasMagic(path, MANIFEST_MAGIC);
+    }
+
+    // Manifest layout: [magic][u32 version][u32 checksum][u64 payload size][payload]
+    static bool writeManifest(const std::string& path, const Manifest& manifest) {
+        std::string payload;
+        putString(payload, manifest.databaseName);
+        putU64(payload, manifest.checkpointLsn);
+        putU64(payload, manifest.nextFileId);
+        putU32(payload, (uint32_t)manifest.tables.size());
+        for (const auto& entry : manifest.tables) {
+            putString(payload, entry.tableName);
+            putString(payload, entry.fileName);
+            putU64(payload, entry.rowCount);
+            putU32(payload, (uint32_t)entry.indexNames.size());
+            for (const auto& indexName : entry.indexNames) putString(payload, indexName);
+        }
+
+        std::string out(MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC));
+        putU32(out, MANIFEST_VERSION);
+        putU32(out, fnv1a(payload.data(), payload.size()));
+        putU64(out, payload.size());
+        out += payload;
+
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            std::cerr << "Error opening file " << path << " for writing" << std::endl;
+            return false;
+        }
+        ofs.write(out.data(), (std::streamsize)out.size());
+        ofs.close();
+        return !ofs.fail();
+    }
+
+    static bool readManifest(const std::string& path, Manifest& manifest) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs.is_open()) {
+            std::cerr << "Error opening file " << path << " for reading" << std::endl;
+            return false;
+        }
+        std::string in((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+        size_t pos = sizeof(MANIFEST_MAGIC), end = in.size();
+        uint32_t version = 0, checksum = 0;
+        uint64_t payloadSize = 0;
+        if (end < pos || std::memcmp(in.data(), MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC)) != 0) {
+            return fail(path, "not a manifest");
+        }
+        if (!getU32(in.data(), pos, end, version) || !getU32(in.data(), pos, end, checksum)
+            || !getU64(in.data(), pos, end, payloadSize)) {
+            return fail(path, "file is truncated");
+        }
+        if (version != MANIFEST_VERSION) return fail(path, "unsupported format version " + std::to_string(version));
+        if (payloadSize != end - pos) return fail(path, "file is truncated");
+        if (fnv1a(in.data() + pos, (size_t)payloadSize) != checksum) return fail(path, "checksum mismatch");
+
+        uint32_t tableCount = 0;
+        if (!getString(in.data(), pos, end, manifest.databaseName) || !getU64(in.data(), pos, end, manifest.checkpointLsn)
+            || !getU64(in.data(), pos, end, manifest.nextFileId) || !getU32(in.data(), pos, end, tableCount)) {
+            return fail(path, "malformed manifest");
+        }
+        for (uint32_t t = 0; t < tableCount; t++) {
+            Manifest::Entry entry;
+            uint32_t indexCount = 0;
+            if (!getString(in.data(), pos, end, entry.tableName) || !getString(in.data(), pos, end, entry.fileName)
+                || !getU64(in.data(), pos, end, entry.rowCount) || !getU32(in.data(), pos, end, indexCount)) {
+                return fail(path, "malformed manifest");
+            }
+            for (uint32_t i = 0; i < indexCount; i++) {
+                std::string indexName;
+                if (!getString(in.data(), pos, end, indexName)) return fail(path, "malformed manifest");
+                entry.indexNames.push_back(std::move(indexName));
+            }
+            manifest.tables.push_back(std::move(entry));
+        }
+        return true;
+    }
+
+    static bool write(const std::string& path, const std::string& dbName, uint64_t checkpointLsn,
+                      const std::vector<std::shared_ptr<Table>>& tables) {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            std::cerr << "Error opening file " << path << " for writing" << std::endl;
+            return false;
+        }
+
+        Header header{};
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header)); // patched at the end
+        uint64_t pos = sizeof(header);
+
+        auto writeBytes = [&ofs, &pos](const void* data, size_t len) {
+            ofs.write(static_cast<const char*>(data), (std::streamsize)len);
+            pos += len;
+        };
+        auto padToPage = [&writeBytes, &pos]() {
+            static const char zeros[PAGE_SIZE] = {};
+            writeBytes(zeros, (size_t)((PAGE_SIZE - pos % PAGE_SIZE) % PAGE_SIZE));
+        };
+
+        std::string directory;
+        putString(directory, dbName);
+        for (const auto& table : tables) {
+            size_t rows = table->rowCount();
+            putString(directory, table->getName());
+            putU64(directory, rows);
+            putU32(directory, (uint32_t)ZoneMap::BLOCK_SIZE);
+            putU32(directory, (uint32_t)table->getColumns().size());
+
+            for (size_t c = 0; c < table->getColumns().size(); c++) {
+                const Column& column = table->getColumns()[c];
+                padToPage();
+                uint64_t offset = pos;
+                switch (column.getType()) {
+                    case DataType::INT:
+                        writeBytes(column.getInts().data(), rows * sizeof(int64_t));
+                        break;
+                    case DataType::FLOAT:
+                        writeBytes(column.getFloats().data(), rows * sizeof(double));
+                        break;
+                    case DataType::TEXT: {
+                        const auto& texts = column.getTexts();
+                        std::vector<uint64_t> offsets(rows + 1, 0);
+                        for (size_t i = 0; i < rows; i++) offsets[i + 1] = offsets[i] + texts[i].size();
+                        writeBytes(offsets.data(), offsets.size() * sizeof(uint64_t));
+                        for (const auto& text : texts) writeBytes(text.data(), text.size());
+                        break;
+                    }
+                }
+                uint64_t size = pos - offset;
+
+                padToPage();
+                uint64_t zoneOffset = pos;
+                std::string zones = encodeZones(table->getZoneMap(c));
+                writeBytes(zones.data(), zones.size());
+
+                putString(directory, column.getTitle());
+                putU8(directory, (uint8_t)column.getType());
+                putU64(directory, offset);
+                putU64(directory, size);
+                putU64(directory, zoneOffset);
+                putU64(directory, zones.size());
+            }
+
+            putU32(directory, (uint32_t)(table->getIndexes().size() + table->getOrderedIndexes().size()));
+            for (const auto& index : table->getIndexes()) {
+                putString(directory, index.getName());
+                putString(directory, index.getColumnName());
+                putU8(directory, (uint8_t)IndexKind::HASH);
+            }
+            for (const auto& index : table->getOrderedIndexes()) {
+                putString(directory, index.getName());
+                putString(directory, index.getColumnName());
+                putU8(directory, (uint8_t)IndexKind::BTREE);
+            }
+        }
+
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.pageSize = PAGE_SIZE;
+        header.checkpointLsn = checkpointLsn;
+        header.directoryOffset = pos;
+        header.directorySize = directory.size();
+        header.directoryChecksum = fnv1a(directory.data(), directory.size());
+        header.tableCount = (uint32_t)tables.size();
+        header.headerChecksum = headerChecksumOf(header);
+        writeBytes(directory.data(), directory.size());
+
+        ofs.seekp(0);
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.close();
+        return !ofs.fail();
+    }
+
+    // Maps the file and validates its header and directory
+    bool open(const std::string& path) {
+        tables.clear();
+        if (!file.open(path)) {
+            std::cerr << "Error opening file " << path << " for reading" << std::endl;
+            return false;
+        }
+
+        Header header{};
+        if (file.size() < sizeof(header)) return fail(path, "file is truncated");
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return fail(path, "not a database file");
+        if (header.version != VERSION) return fail(path, "unsupported format version " + std::to_string(header.version));
+        if (header.byteOrder != BYTE_ORDER_MARK) return fail(path, "written with a different byte order");
+        if (header.pageSize != PAGE_SIZE) return fail(path, "unsupported page size");
+        if (header.headerChecksum != headerChecksumOf(header)) return fail(path, "header checksum mismatch");
+
+        if (header.directoryOffset > file.size() || header.directorySize > file.size() - header.directoryOffset) {
+            return fail(path, "directory out of bounds");
+        }
+        const char* dir = file.data() + header.directoryOffset;
+        if (fnv1a(dir, header.directorySize) != header.directoryChecksum) return fail(path, "directory checksum mismatch");
+
+        size_t pos = 0, end = header.directorySize;
+        if (!getString(dir, pos, end, databaseName)) return fail(path, "malformed directory");
+        for (uint32_t t = 0; t < header.tableCount; t++) {
+            TableEntry entry;
+            uint32_t columnCount = 0, indexCount = 0;
+            if (!getString(dir, pos, end, entry.name) || !getU64(dir, pos, end, entry.rowCount)
+                || !getU32(dir, pos, end, entry.zoneBlockSize)
+                || !getU32(dir, pos, end, columnCount)) {
+                return fail(path, "malformed directory");
+            }
+            for (uint32_t c = 0; c < columnCount; c++) {
+                ColumnEntry column;
+                uint8_t type = 0;
+                if (!getString(dir, pos, end, column.name) || !getU8(dir, pos, end, type)
+                    || !getU64(dir, pos, end, column.offset) || !getU64(dir, pos, end, column.size)
+                    || !getU64(dir, pos, end, column.zoneOffset) || !getU64(dir, pos, end, column.zoneSize)) {
+                    return fail(path, "malformed directory");
+                }
+                if (type > (uint8_t)DataType::TEXT) return fail(path, "unknown column type");
+                column.type = (DataType)type;
+                if (!segmentFits(column, entry.rowCount, header.directoryOffset)) {
+                    return fail(path, "bad segment for column " + entry.name + "." + column.name);
+                }
+                if (!zoneSegmentFits(column, entry.rowCount, entry.zoneBlockSize, header.directoryOffset)) {
+                    return fail(path, "bad zone map for column " + entry.name + "." + column.name);
+                }
+                entry.columns.push_back(std::move(column));
+            }
+            if (!getU32(dir, pos, end, indexCount)) return fail(path, "malformed directory");
+            for (uint32_t i = 0; i < indexCount; i++) {
+                IndexEntry index;
+                uint8_t kind = 0;
+                if (!getString(dir, pos, end, index.name) || !getString(dir, pos, end, index.columnName)
+                    || !getU8(dir, pos, end, kind)) {
+                    return fail(path, "malformed directory");
+                }
+                if (kind > (uint8_t)IndexKind::BTREE) return fail(path, "unknown index kind");
+                index.kind = (IndexKind)kind;
+                entry.indexes.push_back(std::move(index));
+            }
+            tables.push_back(std::move(entry));
+        }
+
+        checkpointLsn = header.checkpointLsn;
+        return true;
+    }
+
+    [[nodiscard]] const std::string& getDatabaseName() const { return databaseName; }
+    [[nodiscard]] uint64_t getCheckpointLsn() const { return checkpointLsn; }
+    [[nodiscard]] const std::vector<TableEntry>& getTables() const { return tables; }
+
+    // Copies one table's segments out of the mapping and rebuilds its indexes.
+    // Returns nullptr (after reporting) if the data is inconsistent.
+    [[nodiscard]] std::shared_ptr<Table> loadTable(const TableEntry& entry) const {
+        std::vector<std::pair<std::string, DataType>> tableConfig;
+        for (const auto& column : entry.columns) tableConfig.emplace_back(column.name, column.type);
+        auto table = std::make_shared<Table>(entry.name, tableConfig);
+
+        size_t rows = (size_t)entry.rowCount;
+        std::vector<Column> columns;
+        columns.reserve(entry.columns.size());
+        std::vector<ZoneMap> zones; // left empty (rebuilt by the table) unless every column has one
+        bool storedZones = entry.zoneBlockSize == ZoneMap::BLOCK_SIZE;
+        for (const auto& columnEntry : entry.columns) {
+            const char* segment = file.data() + columnEntry.offset;
+            Column column(columnEntry.name, columnEntry.type);
+            switch (columnEntry.type) {
+                case DataType::INT: {
+                    std::vector<int64_t> ints(rows);
+                    if (rows) std::memcpy(ints.data(), segment, rows * sizeof(int64_t));
+                    column.assign(std::move(ints));
+                    break;
+                }
+                case DataType::FLOAT: {
+                    std::vector<double> floats(rows);
+                    if (rows) std::memcpy(floats.data(), segment, rows * sizeof(double));
+                    column.assign(std::move(floats));
+                    break;
+                }
+                case DataType::TEXT: {
+                    const char* heap = segment + (rows + 1) * sizeof(uint64_t);
+                    uint64_t heapSize = columnEntry.size - (rows + 1) * sizeof(uint64_t);
+                    std::vector<std::string> texts;
+                    texts.reserve(rows);
+                    uint64_t begin = readU64(segment);
+                    for (size_t i = 0; i < rows; i++) {
+                        uint64_t next = readU64(segment + (i + 1) * sizeof(uint64_t));
+                        if (begin > next || next > heapSize) {
+                            std::cerr << "Corrupt string heap in column " << entry.name << "." << columnEntry.name << std::endl;
+                            return nullptr;
+                        }
+                        texts.emplace_back(heap + begin, (size_t)(next - begin));
+                        begin = next;
+                    }
+                    column.assign(std::move(texts));
+                    break;
+                }
+            }
+            columns.push_back(std::move(column));
+
+            storedZones = storedZones && columnEntry.zoneSize > 0;
+            if (storedZones) {
+                zones.emplace_back(columnEntry.type);
+                if (!decodeZones(file.data() + columnEntry.zoneOffset, columnEntry.zoneSize, rows, zones.back())) {
+                    std::cerr << "Corrupt zone map in column " << entry.name << "." << columnEntry.name << std::endl;
+                    return nullptr;
+                }
+            }
+        }
+        if (!storedZones) zones.clear();
+
+        if (!table->loadColumns(std::move(columns), rows, std::move(zones))) {
+            std::cerr << "Error loading table " << entry.name << std::endl;
+            return nullptr;
+        }
+        for (const auto& index : entry.indexes) {
+            if (!table->createIndex(index.name, index.columnName, index.kind)) {
+                std::cerr << "Error rebuilding index '" << index.name << "'" << std::endl;
+                return nullptr;
+            }
+        }
+        return table;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'M', 'I', 'N', 'I', 'D', 'B', '\r', '\n'};
+    static constexpr char MANIFEST_MAGIC[8] = {'M', 'I', 'N', 'I', 'D', 'B', 'M', 'F'};
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t pageSize;
+        uint64_t checkpointLsn;
+        uint64_t directoryOffset;
+        uint64_t directorySize;
+        uint32_t directoryChecksum;
+        uint32_t tableCount;
+        uint32_t headerChecksum; // over every field before this one
+        uint32_t reserved;
+    };
+    static_assert(sizeof(Header) == 64, "data file header must stay 64 bytes");
+
+    MappedFile file;
+    std::string databaseName;
+    uint64_t checkpointLsn = 0;
+    std::vector<TableEntry> tables;
+
+    static bool hasMagic(const std::string& path, const char (&expected)[8]) {
+        std::ifstream ifs(path, std::ios::binary);
+        char magic[8] = {};
+        return ifs.read(magic, sizeof(magic)) && std::memcmp(magic, expected, sizeof(magic)) == 0;
+    }
+
+    static uint32_t headerChecksumOf(const Header& header) {
+        return fnv1a(reinterpret_cast<const char*>(&header), offsetof(Header, headerChecksum));
+    }
+
+    static bool fail(const std::string& path, const std::string& reason) {
+        std::cerr << "Error reading " << path << ": " << reason << std::endl;
+        return false;
+    }
+
+    // The segment must lie page-aligned before the directory and be exactly as large as
+    // its row count implies (TEXT: at least the offset array)
+    static bool segmentFits(const ColumnEntry& column, uint64_t rows, uint64_t directoryOffset) {
+        if (column.offset % PAGE_SIZE != 0 || column.offset > directoryOffset
+            || column.size > directoryOffset - column.offset) {
+            return false;
+        }
+        if (rows > column.size / sizeof(uint64_t)) return false;
+        if (column.type == DataType::TEXT) return column.size >= (rows + 1) * sizeof(uint64_t);
+        return column.size == rows * sizeof(uint64_t);
+    }
+
+    // The zone map segment, if any, must lie page-aligned before the directory and match the
+    // number of blocks the row count implies (TEXT: at least the offset array)
+    static bool zoneSegmentFits(const ColumnEntry& column, uint64_t rows, uint32_t blockSize, uint64_t directoryOffset) {
+        if (column.zoneSize == 0) return true;
+        if (blockSize == 0 || column.zoneOffset % PAGE_SIZE != 0 || column.zoneOffset > directoryOffset
+            || column.zoneSize > directoryOffset - column.zoneOffset) {
+            return false;
+        }
+        uint64_t blocks = rows / blockSize + (rows % blockSize != 0);
+        switch (column.type) {
+            case DataType::INT: return column.zoneSize == blocks * 2 * sizeof(uint64_t);
+            case DataType::FLOAT: return column.zoneSize == blocks * 3 * sizeof(uint64_t);
+            default: return column.zoneSize >= (2 * blocks + 1) * sizeof(uint64_t);
+        }
+    }
+
+    static std::string encodeZones(const ZoneMap& zones) {
+        std::string out;
+        size_t blocks = zones.blockCount();
+        switch (zones.getType()) {
+            case DataType::INT:
+                for (size_t b = 0; b < blocks; b++) {
+                    putRaw(out, zones.getInts().min[b]);
+                    putRaw(out, zones.getInts().max[b]);
+                }
+                break;
+            case DataType::FLOAT:
+                for (size_t b = 0; b < blocks; b++) {
+                    putRaw(out, zones.getFloats().min[b]);
+                    putRaw(out, zones.getFloats().max[b]);
+                    putU64(out, zones.getNanCounts()[b]);
+                }
+                break;
+            case DataType::TEXT: {
+                const auto& ranges = zones.getTexts();
+                uint64_t offset = 0;
+                putU64(out, offset);
+                for (size_t b = 0; b < blocks; b++) {
+                    putU64(out, offset += ranges.min[b].size());
+                    putU64(out, offset += ranges.max[b].size());
+                }
+                for (size_t b = 0; b < blocks; b++) {
+                    out += ranges.min[b];
+                    out += ranges.max[b];
+                }
+                break;
+            }
+        }
+        return out;
+    }
+
+    // Fills `zones` from a segment that passed zoneSegmentFits
+    static bool decodeZones(const char* segment, uint64_t size, size_t rows, ZoneMap& zones) {
+        size_t blocks = (rows + ZoneMap::BLOCK_SIZE - 1) / ZoneMap::BLOCK_SIZE;
+        size_t pos = 0;
+        switch (zones.getType()) {
+            case DataType::INT: {
+                BlockRanges<int64_t> ranges;
+                ranges.min.resize(blocks);
+                ranges.max.resize(blocks);
+                for (size_t b = 0; b < blocks; b++) {
+                    getRaw(segment, pos, size, ranges.min[b]);
+                    getRaw(segment, pos, size, ranges.max[b]);
+                }
+                zones.assign(std::move(ranges));
+                return true;
+            }
+            case DataType::FLOAT: {
+                BlockRanges<double> ranges;
+                std::vector<uint64_t> nans(blocks);
+                ranges.min.resize(blocks);
+                ranges.max.resize(blocks);
+                for (size_t b = 0; b < blocks; b++) {
+                    getRaw(segment, pos, size, ranges.min[b]);
+                    getRaw(segment, pos, size, ranges.max[b]);
+                    getU64(segment, pos, size, nans[b]);
+                }
+                zones.assign(std::move(ranges), std::move(nans));
+                return true;
+            }
+            case DataType::TEXT: {
+                const char* heap = segment + (2 * blocks + 1) * sizeof(uint64_t);
+                uint64_t heapSize = size - (2 * blocks + 1) * sizeof(uint64_t);
+                BlockRanges<std::string> ranges;
+                ranges.min.reserve(blocks);
+                ranges.max.reserve(blocks);
+                uint64_t begin = readU64(segment);
+                for (size_t i = 0; i < 2 * blocks; i++) {
+                    uint64_t next = readU64(segment + (i + 1) * sizeof(uint64_t));
+                    if (begin > next || next > heapSize) return false;
+                    (i % 2 == 0 ? ranges.min : ranges.max).emplace_back(heap + begin, (size_t)(next - begin));
+                    begin = next;
+                }
+                zones.assign(std::move(ranges));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // -------------------
+    // Directory encoding (host byte order, like the segments)
+    // -------------------
+    template <typename T>
+    static void putRaw(std::string& out, T v) { out.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+    static void putU8(std::string& out, uint8_t v) { putRaw(out, v); }
+    static void putU32(std::string& out, uint32_t v) { putRaw(out, v); }
+    static void putU64(std::string& out, uint64_t v) { putRaw(out, v); }
+
+    static void putString(std::string& out, const std::string& s) {
+        putU32(out, (uint32_t)s.size());
+        out.append(s);
+    }
+
+    static uint64_t readU64(const char* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    template <typename T>
+    static bool getRaw(const char* in, size_t& pos, size_t end, T& out) {
+        if (end - pos < sizeof(T)) return false;
+        std::memcpy(&out, in + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+    static bool getU8(const char* in, size_t& pos, size_t end, uint8_t& out) { return getRaw(in, pos, end, out); }
+    static bool getU32(const char* in, size_t& pos, size_t end, uint32_t& out) { return getRaw(in, pos, end, out); }
+    static bool getU64(const char* in, size_t& pos, size_t end, uint64_t& out) { return getRaw(in, pos, end, out); }
+
+    static bool getString(const char* in, size_t& pos, size_t end, std::string& out) {
+        uint32_t len = 0;
+        if (!getU32(in, pos, end, len) || end - pos < len) return false;
+        out.assign(in + pos, len);
+        pos += len;
+        return true;
+    }
+};
+
+#endif //DATAFILE_H
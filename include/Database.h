@@ -8,117 +8,351 @@
 
 #include "Utils.h"
 #include "Table.h"
+#include "WriteAheadLog.h"
+#include "DataFile.h"
 #include <vector>
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <algorithm>
 
 
 class Database {
 public:
-    explicit Database(const std::string& name): name(name), filename("./databases/" + name + ".db") {
-        // Attempt to load existing database file
-        if (std::ifstream infile(filename); infile.good()) {
-            if (!loadFromFile()) tables.clear();
-        } else {
-            // File doesn't exist; initialize empty database
-        }
-    }
+    explicit Database(const std::string& name, const WalOptions& walOptions = {})
+        : name(name), filename("./databases/" + name + ".db"), tableDir("./databases/" + name + "/"),
+          wal(std::make_unique<WriteAheadLog>("./databases/" + name + ".wal", walOptions)) {}
 
     [[nodiscard]] std::string getName() const { return name; };
 
     bool addTable(const std::string& tableName, const std::vector<std::pair<std::string, DataType>>& tableConfig){
         for (const auto& table: tables){
-          if (table->getName() == tableName) {
-            std::cout << "Table " << table->getName() << " already exists" << std::endl;
+          if (table.name == tableName) {
+            std::cout << "Table " << table.name << " already exists" << std::endl;
             return false;
           }
         }
-        tables.emplace_back(std::make_shared<Table>(tableName, tableConfig));
+        TableSlot slot;
+        slot.name = tableName;
+        slot.table = std::make_shared<Table>(tableName, tableConfig);
+        tables.push_back(std::move(slot));
         return true;
     }
 
     bool dropTable(const std::string& tableName) {
-        auto it = std::remove_if(tables.begin(), tables.end(),
-                                 [&tableName](const std::shared_ptr<Table>& table) {
-                                     return table->getName() == tableName;
-                                 });
+        auto it = std::find_if(tables.begin(), tables.end(),
+                               [&tableName](const TableSlot& table) {
+                                   return table.name == tableName;
+                               });
 
         if (it != tables.end()) {
-          tables.erase(it, tables.end());
+          // The file is unlinked once a checkpoint has written a manifest without it
+          if (!it->fileName.empty()) droppedFiles.push_back(it->fileName);
+          tables.erase(it);
           return true;
         }
         std::cout << "Error: Table \"" << tableName << "\" does not exist\n" << std::endl;
         return false;
     }
 
+    bool createIndex(const std::string& indexName, const std::string& tableName, const std::string& columnName,
+                     IndexKind kind = IndexKind::HASH) {
+        for (const auto& table : tables) {
+            bool exists = table.table
+                ? table.table->hasIndex(indexName)
+                : std::find(table.indexNames.begin(), table.indexNames.end(), indexName) != table.indexNames.end();
+            if (exists) {
+                std::cout << "Index " << indexName << " already exists" << std::endl;
+                return false;
+            }
+        }
+        auto table = getTable(tableName);
+        if (!table) {
+            std::cout << "Error: Table \"" << tableName << "\" does not exist\n" << std::endl;
+            return false;
+        }
+        return table->createIndex(indexName, columnName, kind);
+    }
+
+    // Tables of an opened database are read from their data file on first access
     std::shared_ptr<Table> getTable(const std::string& tableName) {
         for (auto& table: tables) {
-            if (table->getName() == tableName) {
-                return table;
+            if (table.name == tableName) {
+                if (!table.table) loadTable(table);
+                return table.table;
             }
         }
         return nullptr;
     }
 
-    [[nodiscard]] bool saveToFile() const {
-        std::ofstream ofs(filename);
-        if (!ofs.is_open()) {
-            std::cerr << "Error opening file " << filename << " for writing" << std::endl;
+    // -------------------
+    // Write-ahead logging
+    // -------------------
+    // Mutations are recorded in ./databases/<name>.wal instead of rewriting the .db file.
+    // The executor logs each applied change and calls commit() once per statement.
+    void logCreateTable(const std::string& tableName, const std::vector<std::pair<std::string, DataType>>& tableConfig) {
+        WriteAheadLog::Record record(WriteAheadLog::RecordType::CREATE_TABLE, tableName);
+        record.columns = tableConfig;
+        wal->append(std::move(record));
+    }
+
+    void logDropTable(const std::string& tableName) {
+        WriteAheadLog::Record record(WriteAheadLog::RecordType::DROP_TABLE, tableName);
+        wal->append(std::move(record));
+    }
+
+    // One record per statement; the rows' raw values are stored back to back
+    void logInsert(const std::string& tableName, const std::vector<std::vector<std::string>>& rawRows) {
+        WriteAheadLog::Record record(WriteAheadLog::RecordType::INSERT, tableName);
+        for (const auto& rawValues : rawRows) {
+            record.values.insert(record.values.end(), rawValues.begin(), rawValues.end());
+        }
+        wal->append(std::move(record));
+    }
+
+    // One record per statement: the updated rows and the SET clauses, column names and raw
+    // literals alternating
+    void logUpdate(const std::string& tableName, const std::vector<uint64_t>& rowIds,
+                   const std::vector<std::pair<std::string, std::string>>& setClauses) {
+        WriteAheadLog::Record record(WriteAheadLog::RecordType::UPDATE_CELLS, tableName);
+        record.rowIds = rowIds;
+        for (const auto& [column, raw] : setClauses) {
+            record.values.push_back(column);
+            record.values.push_back(raw);
+        }
+        wal->append(std::move(record));
+    }
+
+    void logCreateIndex(const std::string& indexName, const std::string& tableName, const std::string& columnName,
+                        IndexKind kind) {
+        WriteAheadLog::Record record(WriteAheadLog::RecordType::CREATE_INDEX, tableName);
+        record.values = {indexName, columnName, indexKindToString(kind)};
+        wal->append(std::move(record));
+    }
+
+    // Rows marked as deleted by one statement
+    void logDelete(const std::string& tableName, const std::vector<uint64_t>& rowIds) {
+        WriteAheadLog::Record record(WriteAheadLog::RecordType::MARK_DELETED, tableName);
+        record.rowIds = rowIds;
+        wal->append(std::move(record));
+    }
+
+    // Drops the table's deleted rows. Compaction renumbers rows, so it is logged to happen
+    // at the same point on replay, where later records' row ids refer to the new numbers.
+    bool compactTable(const std::string& tableName) {
+        auto table = getTable(tableName);
+        if (!table) {
+            std::cout << "Error: Table \"" << tableName << "\" does not exist\n" << std::endl;
             return false;
         }
+        if (table->deletedRowCount() == 0) return true;
+        table->compact();
+        WriteAheadLog::Record record(WriteAheadLog::RecordType::COMPACT, tableName);
+        wal->append(std::move(record));
+        return true;
+    }
 
-        // Write database name
-        ofs << "DatabaseName " << name << std::endl;
+    // Compacts every loaded table that has deleted rows (tables not loaded have none)
+    void compactTables() {
+        for (const auto& slot : tables) {
+            if (slot.table && slot.table->deletedRowCount() > 0) compactTable(slot.name);
+        }
+    }
 
-        // Write number of tables
-        ofs << "NumberOfTables " << tables.size() << std::endl;
+    // End the statement: its log records are flushed according to the durability
+    // mode, and the log is checkpointed once it has grown past its limit
+    bool commit() {
+        if (!wal->commit()) return false;
+        if (wal->needsCheckpoint()) return checkpoint();
+        return true;
+    }
 
-        // For each table
-        for (const auto& table : tables) {
-            // Write table name
-            ofs << "TableName " << table->getName() << std::endl;
+    // Fold the log into the table files and start a fresh log. Buffered log records
+    // are not written first: the saved tables already contain their changes.
+    bool checkpoint() {
+        if (!saveToFile()) {
+            wal->flush(); // keep the changes recoverable from the log instead
+            return false;
+        }
+        wal->reset();
+        return true;
+    }
 
-            // Write number of columns
-            ofs << "NumberOfColumns " << table->getColumns().size() << std::endl;
+    bool setDurability(DurabilityMode mode) { return wal->setDurability(mode); }
 
-            // For each column, write column name and data type
-            for (const auto& column : table->getColumns()) {
-                ofs << "ColumnName " << column.getTitle() << std::endl;
-                ofs << "DataType " << dataTypeToString(column.getType()) << std::endl;
-            }
+    // Writes every table changed since the last save to a new data file of its own, then
+    // atomically replaces the manifest (temp file + rename) to point at them. Unchanged
+    // tables keep their files. The manifest records the last log sequence number the
+    // tables contain so replay skips records already folded in. Deleted rows are compacted
+    // away first; data files only hold live rows.
+    [[nodiscard]] bool saveToFile() {
+        compactTables();
 
-            // Write number of rows
-            ofs << "NumberOfRows " << table->getRows().size() << std::endl;
+        std::error_code ec;
+        std::filesystem::create_directories(tableDir, ec);
+        if (ec) {
+            std::cerr << "Error creating directory " << tableDir << ": " << ec.message() << std::endl;
+            return false;
+        }
 
-            // For each row, write values
-            for (const auto& row : table->getRows()) {
-                const auto& values = row.getValues();
-                for (size_t i = 0; i < values.size(); ++i) {
-                    const auto& value = values[i];
-                    ofs << value.getRawValue();
+        DataFile::Manifest manifest;
+        manifest.databaseName = name;
+        manifest.checkpointLsn = wal->getLastLsn();
+        manifest.nextFileId = nextFileId;
+
+        std::vector<std::string> written(tables.size()); // new file of each rewritten table
+        for (size_t i = 0; i < tables.size(); i++) {
+            TableSlot& slot = tables[i];
+            if (slot.fileName.empty() || (slot.table && slot.table->getModificationCount() != slot.savedModifications)) {
+                written[i] = slot.name + "." + std::to_string(manifest.nextFileId++) + ".tbl";
+                if (!writeTableFile(slot, written[i])) return false;
+            }
 
-                    if (i != values.size() - 1) {
-                        ofs << "\t"; // Using tab as separator
-                    }
-                }
-                ofs << std::endl;
+            DataFile::Manifest::Entry entry;
+            entry.tableName = slot.name;
+            entry.fileName = written[i].empty() ? slot.fileName : written[i];
+            if (slot.table) {
+                entry.rowCount = slot.table->rowCount();
+                for (const auto& index : slot.table->getIndexes()) entry.indexNames.push_back(index.getName());
+                for (const auto& index : slot.table->getOrderedIndexes()) entry.indexNames.push_back(index.getName());
+            } else {
+                entry.rowCount = slot.rowCount;
+                entry.indexNames = slot.indexNames;
             }
+            manifest.tables.push_back(std::move(entry));
+        }
+
+        std::string tmpFilename = filename + ".tmp";
+        if (!DataFile::writeManifest(tmpFilename, manifest) || !syncFile(tmpFilename)) {
+            std::cerr << "Error writing file " << tmpFilename << std::endl;
+            return false;
+        }
+        std::filesystem::rename(tmpFilename, filename, ec);
+        if (ec) {
+            std::cerr << "Error replacing " << filename << ": " << ec.message() << std::endl;
+            return false;
         }
 
-        ofs.close();
+        // The new manifest is in place: files it no longer refers to can go
+        nextFileId = manifest.nextFileId;
+        for (size_t i = 0; i < tables.size(); i++) {
+            if (written[i].empty()) continue;
+            if (!tables[i].fileName.empty()) std::filesystem::remove(tableDir + tables[i].fileName, ec);
+            tables[i].fileName = written[i];
+            if (tables[i].table) tables[i].savedModifications = tables[i].table->getModificationCount();
+        }
+        for (const auto& dropped : droppedFiles) std::filesystem::remove(tableDir + dropped, ec);
+        droppedFiles.clear();
         return true;
     }
 
+    // Opens the manifest and re-applies everything logged since the last checkpoint.
+    // Only the catalog is read here; a table's file is loaded by getTable on first use.
+    // Databases saved in the original text format are read from that file and split into
+    // table files at the next save.
     [[nodiscard]] bool loadFromFile() {
+        tables.clear(); // Clear existing tables
+        droppedFiles.clear();
+        nextFileId = 0;
+
+        uint64_t checkpointLsn = 0;
+        bool loaded = DataFile::isManifest(filename) ? loadManifest(checkpointLsn) : loadTextFile();
+        if (!loaded) return false;
+
+        return wal->replay(checkpointLsn, [this](const WriteAheadLog::Record& record) {
+            return applyLogRecord(record);
+        });
+    }
+
+private:
+    // Catalog entry of a table; `table` stays null until the table is first accessed
+    struct TableSlot {
+        std::string name;
+        std::shared_ptr<Table> table;
+        std::string fileName;                         // data file in tableDir, empty if never saved
+        uint64_t rowCount = 0;                        // catalog values while not loaded
+        std::vector<std::string> indexNames;
+        uint64_t savedModifications = 0;             // table modification count at the last save
+    };
+
+    std::string name;
+    std::string filename; // manifest
+    std::string tableDir;
+    std::vector<TableSlot> tables;
+    std::vector<std::string> droppedFiles; // unlinked by the next save
+    uint64_t nextFileId = 0;
+    std::unique_ptr<WriteAheadLog> wal;
+
+    void loadTable(TableSlot& slot) {
+        DataFile file;
+        if (!file.open(tableDir + slot.fileName)) return;
+        if (file.getTables().size() != 1 || file.getTables()[0].name != slot.name) {
+            std::cerr << "Data file " << slot.fileName << " does not hold table " << slot.name << std::endl;
+            return;
+        }
+        slot.table = file.loadTable(file.getTables()[0]);
+        if (slot.table) slot.savedModifications = slot.table->getModificationCount();
+    }
+
+    bool writeTableFile(const TableSlot& slot, const std::string& tableFile) const {
+        std::string path = tableDir + tableFile;
+        std::string tmpPath = path + ".tmp";
+        if (!DataFile::write(tmpPath, name, wal->getLastLsn(), {slot.table})
+            || !syncFile(tmpPath)) {
+            std::cerr << "Error writing file " << tmpPath << std::endl;
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            std::cerr << "Error writing " << path << ": " << ec.message() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool loadManifest(uint64_t& checkpointLsn) {
+        DataFile::Manifest manifest;
+        if (!DataFile::readManifest(filename, manifest)) return false;
+
+        name = manifest.databaseName;
+        checkpointLsn = manifest.checkpointLsn;
+        nextFileId = manifest.nextFileId;
+        for (auto& entry : manifest.tables) {
+            TableSlot slot;
+            slot.name = entry.tableName;
+            slot.fileName = entry.fileName;
+            slot.rowCount = entry.rowCount;
+            slot.indexNames = std::move(entry.indexNames);
+            tables.push_back(std::move(slot));
+        }
+        removeUnreferencedFiles();
+        return true;
+    }
+
+    // Files left behind by a save that did not reach its manifest (e.g. a crash)
+    void removeUnreferencedFiles() {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(tableDir, ec)) return;
+        std::vector<std::filesystem::path> stale;
+        for (const auto& file : std::filesystem::directory_iterator(tableDir, ec)) {
+            std::string fileName = file.path().filename().string();
+            bool referenced = std::any_of(tables.begin(), tables.end(),
+                                          [&fileName](const TableSlot& slot) { return slot.fileName == fileName; });
+            if (!referenced) stale.push_back(file.path());
+        }
+        for (const auto& path : stale) std::filesystem::remove(path, ec);
+    }
+
+    // Line-oriented format written before the binary DataFile existed
+    bool loadTextFile() {
         std::ifstream ifs(filename);
         if (!ifs.is_open()) {
             std::cerr << "Error opening file " << filename << " for reading" << std::endl;
             return false;
         }
 
-        tables.clear(); // Clear existing tables
-
         std::string line, token;
         size_t numberOfTables = 0;
 
@@ -257,17 +491,71 @@ public:
             }
 
             // Add table to database
-            tables.push_back(table);
+            TableSlot slot;
+            slot.name = tableName;
+            slot.table = table;
+            tables.push_back(std::move(slot));
         }
 
         ifs.close();
         return true;
     }
 
-private:
-    std::string name;
-    std::string filename;
-    std::vector<std::shared_ptr<Table>> tables;
+    bool applyLogRecord(const WriteAheadLog::Record& record) {
+        using RecordType = WriteAheadLog::RecordType;
+        if (record.type == RecordType::CREATE_TABLE) return addTable(record.tableName, record.columns);
+        if (record.type == RecordType::DROP_TABLE) return dropTable(record.tableName);
+        if (record.type == RecordType::CREATE_INDEX) {
+            if (record.values.size() != 3) return false;
+            try {
+                return createIndex(record.values[0], record.tableName, record.values[1], stringToIndexKind(record.values[2]));
+            } catch (const std::invalid_argument& e) {
+                std::cerr << e.what() << std::endl;
+                return false;
+            }
+        }
+
+        auto table = getTable(record.tableName);
+        if (!table) {
+            std::cerr << "Log refers to unknown table " << record.tableName << std::endl;
+            return false;
+        }
+        switch (record.type) {
+            case RecordType::INSERT: {
+                size_t width = table->getColumns().size();
+                if (width == 0 || record.values.empty() || record.values.size() % width != 0) return false;
+                std::vector<std::vector<std::string>> rawRows;
+                rawRows.reserve(record.values.size() / width);
+                for (auto it = record.values.begin(); it != record.values.end(); it += width) {
+                    rawRows.emplace_back(it, it + width);
+                }
+                return table->addRows(rawRows);
+            }
+            case RecordType::UPDATE_CELLS: {
+                if (record.values.size() % 2 != 0) return false;
+                std::vector<std::pair<size_t, Value>> assignments;
+                for (size_t i = 0; i < record.values.size(); i += 2) {
+                    int colIdx = table->findColumnIndex(record.values[i]);
+                    if (colIdx == -1) return false;
+                    assignments.emplace_back(colIdx, parseRawValue(table->getTypeConfig()[colIdx], record.values[i + 1]));
+                }
+                for (auto rowIdx : record.rowIds) {
+                    if (!table->updateCells(rowIdx, assignments)) return false;
+                }
+                return true;
+            }
+            case RecordType::MARK_DELETED:
+                for (auto rowIdx : record.rowIds) {
+                    if (!table->deleteRow(rowIdx)) return false;
+                }
+                return true;
+            case RecordType::COMPACT:
+                table->compact();
+                return true;
+            default:
+                return false;
+        }
+    }
 };
 
 
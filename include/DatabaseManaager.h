@@ -12,7 +12,16 @@
 
 class DatabaseManager {
 public:
-    DatabaseManager() : currentDatabase(nullptr) {}
+    explicit DatabaseManager(const WalOptions& walOptions = {}) : currentDatabase(nullptr), walOptions(walOptions) {}
+
+    // Fold every open database's log into its .db file on shutdown
+    ~DatabaseManager() {
+        for (auto& db : databases) {
+            if (!db->checkpoint()) {
+                std::cerr << "Failed to checkpoint database " << db->getName() << std::endl;
+            }
+        }
+    }
 
     bool useDatabase(const std::string& database_name) {
         // Check if the database is already loaded
@@ -23,8 +32,8 @@ public:
             }
         }
 
-        // Attempt to load the database from file
-        auto db = std::make_shared<Database>(database_name);
+        // Attempt to open the database file (reads the catalog, tables load on first use)
+        auto db = std::make_shared<Database>(database_name, walOptions);
         if (db->loadFromFile()) {
             databases.push_back(db);
             currentDatabase = db;
@@ -53,7 +62,7 @@ public:
         }
 
         // Create a new database and save it to file
-        auto db = std::make_shared<Database>(database_name);
+        auto db = std::make_shared<Database>(database_name, walOptions);
         if (db->saveToFile()) {
             databases.push_back(db);
             return true;
@@ -63,11 +72,22 @@ public:
         }
     }
 
+    // Applies to the open databases and to those opened later in this session
+    void setDurability(DurabilityMode mode) {
+        walOptions.durability = mode;
+        for (auto& db : databases) {
+            if (!db->setDurability(mode)) {
+                std::cerr << "Failed to flush the log of database " << db->getName() << std::endl;
+            }
+        }
+    }
+
     [[nodiscard]] std::shared_ptr<Database> currentDB() const { return currentDatabase; }
 
 private:
     std::vector<std::shared_ptr<Database>> databases;
     std::shared_ptr<Database> currentDatabase;
+    WalOptions walOptions;
 };
 
 #endif // DATABASEMANAGER_H
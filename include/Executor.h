@@ -9,12 +9,21 @@
 #include "Comands.h"
 #include "DatabaseManaager.h"
 #include "Condition.h"
-#include <map>
+#include "BoundExpression.h"
+#include "ThreadPool.h"
+#include "CsvImporter.h"
+#include "ResultWriter.h"
+#include "JoinPlanner.h"
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
 
 class Executor {
 public:
-    Executor(std::shared_ptr<DatabaseManager> dbManager, std::ostream& outputStream = std::cout)
-        : dbManager(std::move(dbManager)), out(outputStream), firstSelectQuery(true) {}
+    // numThreads sizes the pool used for parallel table scans (1 = single-threaded)
+    Executor(std::shared_ptr<DatabaseManager> dbManager, std::ostream& outputStream = std::cout,
+             size_t numThreads = ThreadPool::defaultThreadCount())
+        : dbManager(std::move(dbManager)), writer(outputStream), firstSelectQuery(true), pool(numThreads) {}
 
     void execute(Command* cmd) {
         if (!cmd) {
@@ -35,14 +44,26 @@ public:
             auto c = dynamic_cast<CreateTableCommand*>(cmd);
             if (!c) return;
             handleCreateTable(c);
+        } else if (type == "CREATE_INDEX") {
+            auto c = dynamic_cast<CreateIndexCommand*>(cmd);
+            if (!c) return;
+            handleCreateIndex(c);
         } else if (type == "DROP_TABLE") {
             auto c = dynamic_cast<DropTableCommand*>(cmd);
             if (!c) return;
             handleDropTable(c);
+        } else if (type == "SET_DURABILITY") {
+            auto c = dynamic_cast<SetDurabilityCommand*>(cmd);
+            if (!c) return;
+            handleSetDurability(c);
         } else if (type == "INSERT") {
             auto c = dynamic_cast<InsertCommand*>(cmd);
             if (!c) return;
             handleInsert(c);
+        } else if (type == "COPY") {
+            auto c = dynamic_cast<CopyCommand*>(cmd);
+            if (!c) return;
+            handleCopy(c);
         } else if (type == "SELECT") {
             auto c = dynamic_cast<SelectCommand*>(cmd);
             if (!c) return;
@@ -55,6 +76,10 @@ public:
             auto c = dynamic_cast<DeleteCommand*>(cmd);
             if (!c) return;
             handleDelete(c);
+        } else if (type == "VACUUM") {
+            auto c = dynamic_cast<VacuumCommand*>(cmd);
+            if (!c) return;
+            handleVacuum(c);
         } else {
             std::cerr << "Unknown command type: " << type << "\n";
         }
@@ -62,8 +87,12 @@ public:
 
 private:
     std::shared_ptr<DatabaseManager> dbManager;
-    std::ostream& out;
+    ResultWriter writer; // SELECT results, flushed to the output stream after each result
     bool firstSelectQuery;
+    ThreadPool pool;
+
+    // Rows per unit of parallel scan work
+    static constexpr size_t MORSEL_SIZE = 16 * BoundExpression::BATCH_SIZE;
 
     void handleCreateDatabase(CreateDatabaseCommand* cmd) {
         if (!dbManager->createDatabase(cmd->getDatabaseName())) {
@@ -90,7 +119,8 @@ private:
         if (!db->addTable(cmd->getTableName(), cmd->getColumns())) {
             std::cerr << "Failed to create table: " << cmd->getTableName() << "\n";
         } else {
-            db->saveToFile();
+            db->logCreateTable(cmd->getTableName(), cmd->getColumns());
+            db->commit();
             std::cout << "Table " << cmd->getTableName() << " created.\n";
         }
     }
@@ -104,11 +134,40 @@ private:
         if (!db->dropTable(cmd->getTableName())) {
             std::cerr << "Failed to drop table: " << cmd->getTableName() << "\n";
         } else {
-            db->saveToFile();
+            db->logDropTable(cmd->getTableName());
+            // Checkpointing writes a manifest without the table and unlinks its file
+            db->checkpoint();
             std::cout << "Table " << cmd->getTableName() << " dropped.\n";
         }
     }
 
+    void handleSetDurability(SetDurabilityCommand* cmd) {
+        DurabilityMode mode;
+        try {
+            mode = stringToDurabilityMode(cmd->getMode());
+        } catch (const std::invalid_argument& e) {
+            std::cerr << e.what() << "\n";
+            return;
+        }
+        dbManager->setDurability(mode);
+        std::cout << "Durability set to " << cmd->getMode() << ".\n";
+    }
+
+    void handleCreateIndex(CreateIndexCommand* cmd) {
+        auto db = dbManager->currentDB();
+        if (!db) {
+            std::cerr << "No database selected.\n";
+            return;
+        }
+        if (!db->createIndex(cmd->getIndexName(), cmd->getTableName(), cmd->getColumnName(), cmd->getKind())) {
+            std::cerr << "Failed to create index: " << cmd->getIndexName() << "\n";
+        } else {
+            db->logCreateIndex(cmd->getIndexName(), cmd->getTableName(), cmd->getColumnName(), cmd->getKind());
+            db->commit();
+            std::cout << "Index " << cmd->getIndexName() << " created.\n";
+        }
+    }
+
     void handleInsert(InsertCommand* cmd) {
         auto db = dbManager->currentDB();
         if (!db) {
@@ -122,11 +181,50 @@ private:
             return;
         }
 
-        if (!table->addRow(cmd->getValues())) {
+        // All tuples go in as one batch with one log record and one commit
+        const auto& rows = cmd->getRows();
+        if (!table->addRows(rows)) {
             std::cerr << "Failed to insert row into " << cmd->getTableName() << "\n";
         } else {
-            db->saveToFile();
-            std::cout << "Row inserted into " << cmd->getTableName() << ".\n";
+            db->logInsert(cmd->getTableName(), rows);
+            db->commit();
+            if (rows.size() == 1) {
+                std::cout << "Row inserted into " << cmd->getTableName() << ".\n";
+            } else {
+                std::cout << rows.size() << " rows inserted into " << cmd->getTableName() << ".\n";
+            }
+        }
+    }
+
+    void handleCopy(CopyCommand* cmd) {
+        auto db = dbManager->currentDB();
+        if (!db) {
+            std::cerr << "No database selected.\n";
+            return;
+        }
+
+        auto table = db->getTable(cmd->getTableName());
+        if (!table) {
+            std::cerr << "Table " << cmd->getTableName() << " not found.\n";
+            return;
+        }
+
+        // Rows go straight into the columns. They bypass the log: a single checkpoint
+        // at the end makes the whole load durable. If it fails the rows are dropped again,
+        // since later log records would otherwise refer to rows replay cannot recreate.
+        size_t copied = 0;
+        bool failed = !CsvImporter::import(cmd->getPath(), *table, cmd->hasHeader(), pool, copied);
+
+        if (copied > 0 && !db->checkpoint()) {
+            // The checkpoint may have compacted older rows, but the copied ones are still last
+            table->truncate(table->rowCount() - copied);
+            std::cerr << "Failed to save table " << cmd->getTableName() << " after COPY; no rows were copied.\n";
+            return;
+        }
+        if (failed) {
+            std::cerr << "COPY stopped after " << copied << " rows.\n";
+        } else {
+            std::cout << copied << " rows copied into " << cmd->getTableName() << ".\n";
         }
     }
 
@@ -143,8 +241,31 @@ private:
             return;
         }
 
-        WhereClause wc = parseWhereClause(cmd->getWhereClause());
-        auto rows = filterRows(mainTable, wc);
+        const WhereClause& wc = cmd->getWhereClause();
+
+        // Without joins and aggregates, ORDER BY ranks row ids straight from the column
+        // storage (or walks an ordered index) and only materializes the printed rows
+        if (cmd->getJoins().empty() && !cmd->isAggregation() && !cmd->getOrderBy().empty()) {
+            selectTopRows(cmd, mainTable, wc);
+            return;
+        }
+
+        // A bare LIMIT only needs the first offset + limit result rows, so the scan
+        // (or the last join) stops as soon as it has produced them
+        size_t maxRows = SIZE_MAX;
+        if (cmd->hasLimit() && cmd->getOrderBy().empty() && !cmd->isAggregation()) {
+            maxRows = cmd->getOffset() + (size_t)cmd->getLimit();
+        }
+
+        const auto& joins = cmd->getJoins();
+        std::vector<std::vector<size_t>> mainParts;
+        if (!matchRowParts(*mainTable, wc, mainParts, joins.empty() ? maxRows : SIZE_MAX)) return;
+
+        // With two or more joins the planner may find a cheaper order than the written one;
+        // otherwise the joins below run as written on the materialized rows
+        std::vector<Row> rows;
+        bool planned = joins.size() >= 2 && joinInPlannedOrder(db, mainTable, joins, mainParts, maxRows, rows);
+        if (!planned) materializeRows(*mainTable, mainParts, rows, joins.empty() ? maxRows : SIZE_MAX);
 
         // Current schema is mainTable's schema
         std::vector<DataType> currentSchema = mainTable->getTypeConfig();
@@ -160,7 +281,8 @@ private:
         }
 
         // For each join
-        for (const auto& join : cmd->getJoins()) {
+        for (size_t j = 0; j < joins.size(); j++) {
+            const auto& join = joins[j];
             auto jt = db->getTable(join.tableName);
             if (!jt) {
                 std::cerr << "Join table " << join.tableName << " not found.\n";
@@ -168,7 +290,11 @@ private:
             }
 
             // Perform the join
-            rows = performJoin(rows, currentSchema, currentColNames, jt, join.condition);
+            bool lastJoin = (j + 1 == joins.size());
+            if (!planned) {
+                rows = performJoin(rows, currentSchema, currentColNames, jt, join.condition,
+                                   lastJoin ? maxRows : SIZE_MAX);
+            }
 
             // Update schema by merging jt schema
             auto jtSchema = jt->getTypeConfig();
@@ -182,10 +308,341 @@ private:
             }
         }
 
+        // Aggregates replace the rows by one row per group, named by the select list
+        if (cmd->isAggregation()) {
+            std::vector<DataType> aggSchema;
+            std::vector<Row> aggRows;
+            if (!aggregateRows(cmd, currentSchema, currentColNames, rows, aggSchema, aggRows)) return;
+            currentSchema = std::move(aggSchema);
+            currentColNames = cmd->getColumns();
+            rows = std::move(aggRows);
+        }
+
+        if (!cmd->getOrderBy().empty()) {
+            std::vector<int> keyCols;
+            if (!resolveOrderBy(cmd, currentColNames, keyCols)) return;
+            const auto& orderBy = cmd->getOrderBy();
+            auto before = [&](size_t a, size_t b) {
+                for (size_t k = 0; k < keyCols.size(); k++) {
+                    int cmp = compareCells(rows[a].getValue(keyCols[k]), rows[b].getValue(keyCols[k]));
+                    if (cmp != 0) return orderBy[k].descending ? cmp > 0 : cmp < 0;
+                }
+                return a < b;
+            };
+            std::vector<size_t> order = topN(rows.size(), resultWindowEnd(cmd, rows.size()), before);
+            std::vector<Row> sorted;
+            sorted.reserve(order.size());
+            for (size_t i : order) sorted.push_back(std::move(rows[i]));
+            rows = std::move(sorted);
+        }
+
+        applyLimit(cmd, rows);
+
         // After all joins applied and rows filtered, print results
         printFinalSelectResults(cmd->getColumns(), currentSchema, currentColNames, rows);
     }
 
+    // ORDER BY on a single table: ranks the matching row ids by comparing the typed column
+    // storage directly, then materializes only the rows that are printed. If the WHERE
+    // clause cannot use an index and the single ORDER BY column has a B+tree index, rows
+    // are taken from the index in key order instead, stopping after the last printed one.
+    void selectTopRows(SelectCommand* cmd, const std::shared_ptr<Table>& table, const WhereClause& wc) {
+        std::vector<std::string> colNames;
+        for (auto& c : table->getColumns()) colNames.push_back(c.getTitle());
+
+        std::vector<int> keyCols;
+        if (!resolveOrderBy(cmd, colNames, keyCols)) return;
+
+        BoundExpression expr;
+        if (!expr.bind(wc, *table)) return;
+        std::vector<size_t> ids;
+        if (expr.findIndexCandidates(*table, ids)) {
+            ids.erase(std::remove_if(ids.begin(), ids.end(), [&expr](size_t i) { return !expr.evaluate(i); }), ids.end());
+        } else if (const BTreeIndex* index = keyCols.size() == 1 ? table->getOrderedIndexOnColumn(keyCols[0]) : nullptr) {
+            selectInIndexOrder(cmd, table, *index, expr, colNames);
+            return;
+        } else {
+            for (auto& part : scanMorsels(*table, expr)) ids.insert(ids.end(), part.begin(), part.end());
+        }
+
+        const auto& orderBy = cmd->getOrderBy();
+        const auto& columns = table->getColumns();
+        auto before = [&](size_t a, size_t b) {
+            for (size_t k = 0; k < keyCols.size(); k++) {
+                const Column& col = columns[keyCols[k]];
+                int cmp = 0;
+                switch (col.getType()) {
+                    case DataType::INT: cmp = compareCells(col.getInts()[ids[a]], col.getInts()[ids[b]]); break;
+                    case DataType::FLOAT: cmp = compareCells(col.getFloats()[ids[a]], col.getFloats()[ids[b]]); break;
+                    case DataType::TEXT: cmp = compareCells(col.getTexts()[ids[a]], col.getTexts()[ids[b]]); break;
+                }
+                if (cmp != 0) return orderBy[k].descending ? cmp > 0 : cmp < 0;
+            }
+            return a < b;
+        };
+
+        std::vector<Row> rows;
+        for (size_t i : topN(ids.size(), resultWindowEnd(cmd, ids.size()), before)) {
+            rows.push_back(table->getRow(ids[i]));
+        }
+        applyLimit(cmd, rows);
+        printFinalSelectResults(cmd->getColumns(), table->getTypeConfig(), colNames, rows);
+    }
+
+    // Walks the ORDER BY column's B+tree index in key order (equal keys in row order, as
+    // the sort would leave them) and keeps the matching rows of the OFFSET/LIMIT window
+    void selectInIndexOrder(SelectCommand* cmd, const std::shared_ptr<Table>& table, const BTreeIndex& index,
+                            const BoundExpression& expr, const std::vector<std::string>& colNames) {
+        size_t end = cmd->hasLimit() ? cmd->getOffset() + (size_t)cmd->getLimit() : SIZE_MAX;
+        size_t matched = 0;
+        std::vector<Row> rows;
+        auto visit = [&](size_t rowIdx) {
+            if (matched == end) return false;
+            if (expr.evaluate(rowIdx) && matched++ >= cmd->getOffset()) rows.push_back(table->getRow(rowIdx));
+            return matched < end;
+        };
+
+        bool descending = cmd->getOrderBy()[0].descending;
+        auto walk = [&](const auto& tree) {
+            using Key = typename std::decay_t<decltype(tree)>::KeyType;
+            if (descending) tree.scanDescending(visit);
+            else tree.scan(KeyRange<Key>{}, visit);
+        };
+        switch (table->getColumns()[index.getColumnIdx()].getType()) {
+            case DataType::INT: walk(index.getInts()); break;
+            case DataType::FLOAT: walk(index.getFloats()); break;
+            case DataType::TEXT: walk(index.getTexts()); break;
+        }
+        printFinalSelectResults(cmd->getColumns(), table->getTypeConfig(), colNames, rows);
+    }
+
+    // Sort order of ORDER BY: ascending values, with NaN after every other value as in the
+    // B+tree (KeyOrder), so sorting and ordered index scans agree and the order is total
+    template <typename T>
+    static int compareCells(const T& a, const T& b) {
+        return (a > b) - (a < b);
+    }
+
+    static int compareCells(double a, double b) {
+        return KeyOrder<double>::less(b, a) - KeyOrder<double>::less(a, b);
+    }
+
+    static int compareCells(const Value& a, const Value& b) {
+        if (a.getType() == DataType::INT && b.getType() == DataType::INT) return compareCells(a.getInt(), b.getInt());
+        if (a.isNumeric() && b.isNumeric()) return compareCells(a.asDouble(), b.asDouble());
+        return compareCells(a.getText(), b.getText());
+    }
+
+    bool resolveOrderBy(SelectCommand* cmd, const std::vector<std::string>& colNames, std::vector<int>& keyCols) {
+        for (auto& key : cmd->getOrderBy()) {
+            int idx = findResultColumn(colNames, key.column);
+            if (idx == -1) {
+                std::cerr << "ORDER BY column " << key.column << " not found.\n";
+                return false;
+            }
+            keyCols.push_back(idx);
+        }
+        return true;
+    }
+
+    // Number of leading rows in ORDER BY order the statement can print: offset + limit
+    static size_t resultWindowEnd(SelectCommand* cmd, size_t rowCount) {
+        if (!cmd->hasLimit()) return rowCount;
+        return std::min(rowCount, cmd->getOffset() + (size_t)cmd->getLimit());
+    }
+
+    // Returns the first k of the ids [0, n) in the order given by before (a strict total
+    // order). k < n keeps a bounded max-heap of the best k seen so far: O(n log k)
+    // instead of sorting everything.
+    template <typename Before>
+    static std::vector<size_t> topN(size_t n, size_t k, Before before) {
+        std::vector<size_t> order;
+        if (k >= n) {
+            order.resize(n);
+            for (size_t i = 0; i < n; i++) order[i] = i;
+            std::sort(order.begin(), order.end(), before);
+            return order;
+        }
+        if (k == 0) return order;
+
+        // The heap's top is the worst of the rows kept so far
+        order.reserve(k);
+        for (size_t i = 0; i < n; i++) {
+            if (order.size() < k) {
+                order.push_back(i);
+                std::push_heap(order.begin(), order.end(), before);
+            } else if (before(i, order.front())) {
+                std::pop_heap(order.begin(), order.end(), before);
+                order.back() = i;
+                std::push_heap(order.begin(), order.end(), before);
+            }
+        }
+        std::sort_heap(order.begin(), order.end(), before);
+        return order;
+    }
+
+    // Drops the rows before OFFSET and after LIMIT
+    static void applyLimit(SelectCommand* cmd, std::vector<Row>& rows) {
+        size_t begin = std::min(cmd->getOffset(), rows.size());
+        size_t end = cmd->hasLimit() ? std::min(rows.size(), begin + (size_t)cmd->getLimit()) : rows.size();
+        rows.erase(rows.begin() + end, rows.end());
+        rows.erase(rows.begin(), rows.begin() + begin);
+    }
+
+    // Running state of one aggregate within one group
+    struct AggregateState {
+        int64_t count = 0;
+        int64_t intSum = 0;
+        double floatSum = 0;
+        std::vector<Value> extreme; // MIN / MAX so far, empty until the first row
+    };
+
+    // Resolves "table.col" or "col" against the current column names, like printFinalSelectResults
+    static int findResultColumn(const std::vector<std::string>& colNames, const std::string& c) {
+        for (int i = 0; i < (int)colNames.size(); i++) {
+            if (colNames[i] == c) return i;
+            auto pos = colNames[i].find('.');
+            std::string cNameOnly = (pos != std::string::npos) ? colNames[i].substr(pos + 1) : colNames[i];
+            if (cNameOnly == c) return i;
+        }
+        return -1;
+    }
+
+    // Hash aggregation: rows are bucketed by their GROUP BY values and every aggregate is
+    // folded into its group's state in a single pass. Groups come out in first-seen order.
+    // Produces one row per group with the select list's columns, typed in outSchema.
+    bool aggregateRows(SelectCommand* cmd,
+                       const std::vector<DataType>& schema,
+                       const std::vector<std::string>& colNames,
+                       const std::vector<Row>& rows,
+                       std::vector<DataType>& outSchema,
+                       std::vector<Row>& outRows) {
+        std::vector<int> groupCols;
+        for (auto& g : cmd->getGroupBy()) {
+            int idx = findResultColumn(colNames, g);
+            if (idx == -1) {
+                std::cerr << "GROUP BY column " << g << " not found.\n";
+                return false;
+            }
+            groupCols.push_back(idx);
+        }
+
+        // Without aggregates, every select column is a plain column
+        std::vector<SelectCommand::Aggregate> items = cmd->getAggregates();
+        if (items.empty()) {
+            for (auto& c : cmd->getColumns()) items.push_back({"", c});
+        }
+
+        // Resolve every select item to its input column (-1 for COUNT(*)) and result type
+        std::vector<int> itemCols;
+        for (auto& item : items) {
+            if (item.function == "COUNT" && item.column == "*") {
+                itemCols.push_back(-1);
+                outSchema.push_back(DataType::INT);
+                continue;
+            }
+            int idx = findResultColumn(colNames, item.column);
+            if (idx == -1) {
+                std::cerr << "Column " << item.column << " not found.\n";
+                return false;
+            }
+            DataType type = schema[idx];
+            if (item.function.empty()) {
+                if (std::find(groupCols.begin(), groupCols.end(), idx) == groupCols.end()) {
+                    std::cerr << "Column " << item.column << " must appear in GROUP BY or be used in an aggregate.\n";
+                    return false;
+                }
+            } else if ((item.function == "SUM" || item.function == "AVG") && type == DataType::TEXT) {
+                std::cerr << item.function << " requires a numeric column: " << item.column << "\n";
+                return false;
+            }
+            itemCols.push_back(idx);
+
+            if (item.function == "COUNT") outSchema.push_back(DataType::INT);
+            else if (item.function == "AVG") outSchema.push_back(DataType::FLOAT);
+            else outSchema.push_back(type);
+        }
+
+        // Group key: length-prefixed raw values of the GROUP BY columns
+        std::unordered_map<std::string, size_t> groupIndex;
+        std::vector<size_t> firstRows; // representative input row of each group
+        std::vector<std::vector<AggregateState>> states;
+        std::string key;
+        for (size_t r = 0; r < rows.size(); r++) {
+            const Row& row = rows[r];
+            key.clear();
+            for (int g : groupCols) {
+                const Value& v = row.getValue(g);
+                std::string raw = v.getType() == DataType::FLOAT ? Value(normalizeKey(v.getFloat())).getRawValue() : v.getRawValue();
+                key += std::to_string(raw.size());
+                key += ':';
+                key += raw;
+            }
+
+            auto it = groupIndex.find(key);
+            size_t group;
+            if (it == groupIndex.end()) {
+                group = states.size();
+                groupIndex.emplace(key, group);
+                firstRows.push_back(r);
+                states.emplace_back(items.size());
+            } else {
+                group = it->second;
+            }
+
+            for (size_t i = 0; i < items.size(); i++) {
+                const std::string& function = items[i].function;
+                if (function.empty()) continue;
+                AggregateState& state = states[group][i];
+                state.count++;
+                if (itemCols[i] == -1 || function == "COUNT") continue;
+
+                const Value& v = row.getValue(itemCols[i]);
+                if (function == "SUM" || function == "AVG") {
+                    if (v.getType() == DataType::INT) state.intSum += v.getInt();
+                    else state.floatSum += v.getFloat();
+                } else if (state.extreme.empty()) {
+                    state.extreme.push_back(v);
+                } else if (function == "MIN" ? v < state.extreme[0] : v > state.extreme[0]) {
+                    state.extreme[0] = v;
+                }
+            }
+        }
+
+        // A global aggregate over no rows still yields one row when every item has a value for it
+        if (groupCols.empty() && states.empty()) {
+            for (auto& item : items) {
+                if (item.function != "COUNT" && item.function != "SUM") return true;
+            }
+            states.emplace_back(items.size());
+        }
+
+        outRows.reserve(states.size());
+        for (size_t group = 0; group < states.size(); group++) {
+            std::vector<Value> values;
+            values.reserve(items.size());
+            for (size_t i = 0; i < items.size(); i++) {
+                const std::string& function = items[i].function;
+                const AggregateState& state = states[group][i];
+                if (function.empty()) {
+                    values.push_back(rows[firstRows[group]].getValue(itemCols[i]));
+                } else if (function == "COUNT") {
+                    values.emplace_back(state.count);
+                } else if (function == "SUM") {
+                    if (outSchema[i] == DataType::INT) values.emplace_back(state.intSum);
+                    else values.emplace_back(state.floatSum);
+                } else if (function == "AVG") {
+                    double sum = schema[itemCols[i]] == DataType::INT ? (double)state.intSum : state.floatSum;
+                    values.emplace_back(sum / (double)state.count);
+                } else {
+                    values.push_back(state.extreme[0]);
+                }
+            }
+            outRows.emplace_back(std::move(values));
+        }
+        return true;
+    }
+
     void handleUpdate(UpdateCommand* cmd) {
         auto db = dbManager->currentDB();
         if (!db) {
@@ -199,48 +656,35 @@ private:
             return;
         }
 
-        WhereClause wc = parseWhereClause(cmd->getWhereClause());
-        auto& allRows = table->getRows();
+        const WhereClause& wc = cmd->getWhereClause();
 
-        // First, map column names to indices
-        std::map<std::string, int> colMap;
-        for (int i = 0; i < (int)table->getColumns().size(); i++) {
-            colMap[table->getColumns()[i].getTitle()] = i;
-        }
-
-        // Identify which columns to update
-        std::vector<std::pair<int, std::string>> updates;
+        // SET literals are parsed once for the whole statement
+        std::vector<std::pair<size_t, Value>> assignments;
         for (auto& u : cmd->getSetClauses()) {
-            auto it = colMap.find(u.first);
-            if (it == colMap.end()) {
+            int colIdx = table->findColumnIndex(u.first);
+            if (colIdx == -1) {
                 std::cerr << "Column " << u.first << " not found in " << cmd->getTableName() << "\n";
                 return;
             }
-            updates.push_back({it->second, u.second});
+            assignments.emplace_back(colIdx, parseRawValue(table->getTypeConfig()[colIdx], u.second));
         }
 
-        // For each row that matches wc, update it
-        for (size_t i = 0; i < allRows.size(); i++) {
-            if (evaluateWhereClause(wc, *table, allRows[i])) {
-                auto vals = allRows[i].getValues();
-                std::vector<std::string> rawValues;
-                rawValues.reserve(vals.size());
-                for (auto& v : vals) {
-                    rawValues.push_back(v.getRawValue());
-                }
-
-                // Apply updates
-                for (auto& up : updates) {
-                    rawValues[up.first] = up.second;
-                }
+        std::vector<size_t> matched;
+        if (!matchRows(*table, wc, matched)) return;
 
-                if (!table->updateRowValues(i, rawValues)) {
-                    std::cerr << "Failed to update row at index " << i << "\n";
-                }
+        // Only the assigned cells of each matching row are overwritten
+        std::vector<uint64_t> updated;
+        updated.reserve(matched.size());
+        for (size_t i : matched) {
+            if (!table->updateCells(i, assignments)) {
+                std::cerr << "Failed to update row at index " << i << "\n";
+            } else {
+                updated.push_back((uint64_t)i);
             }
         }
 
-        db->saveToFile();
+        if (!updated.empty()) db->logUpdate(cmd->getTableName(), updated, cmd->getSetClauses());
+        db->commit();
         std::cout << "Rows updated in " << cmd->getTableName() << ".\n";
     }
 
@@ -257,26 +701,329 @@ private:
             return;
         }
 
-        WhereClause wc = parseWhereClause(cmd->getWhereClause());
-        auto& allRows = table->getRows();
+        const WhereClause& wc = cmd->getWhereClause();
 
-        for (int i = (int)allRows.size() - 1; i >= 0; i--) {
-            if (evaluateWhereClause(wc, *table, allRows[i])) {
-                if (!table->deleteRow((size_t)i)) {
-                    std::cerr << "Failed to delete row at index " << i << "\n";
-                }
+        std::vector<size_t> matched;
+        if (!matchRows(*table, wc, matched)) return;
+
+        // Rows are only marked, so the ids of the remaining matches stay valid
+        std::vector<uint64_t> deleted;
+        deleted.reserve(matched.size());
+        for (size_t i : matched) {
+            if (!table->deleteRow(i)) {
+                std::cerr << "Failed to delete row at index " << i << "\n";
+            } else {
+                deleted.push_back((uint64_t)i);
             }
         }
 
-        db->saveToFile();
+        if (!deleted.empty()) db->logDelete(cmd->getTableName(), deleted);
+        if (table->needsCompaction()) db->compactTable(cmd->getTableName());
+        db->commit();
         std::cout << "Rows deleted from " << cmd->getTableName() << ".\n";
     }
 
-    std::vector<Row> filterRows(std::shared_ptr<Table> table, const WhereClause& wc) {
-        std::vector<Row> result;
-        for (auto& r : table->getRows()) {
-            if (evaluateWhereClause(wc, *table, r)) {
-                result.push_back(r);
+    void handleVacuum(VacuumCommand* cmd) {
+        auto db = dbManager->currentDB();
+        if (!db) {
+            std::cerr << "No database selected.\n";
+            return;
+        }
+
+        if (cmd->getTableName().empty()) {
+            db->compactTables();
+            db->commit();
+            std::cout << "Database " << db->getName() << " vacuumed.\n";
+        } else if (!db->compactTable(cmd->getTableName())) {
+            std::cerr << "Failed to vacuum table: " << cmd->getTableName() << "\n";
+        } else {
+            db->commit();
+            std::cout << "Table " << cmd->getTableName() << " vacuumed.\n";
+        }
+    }
+
+    // Materializes the rows satisfying wc, in table order. At most maxRows rows are
+    // produced; a bounded request lets the scan stop early.
+    bool filterRows(std::shared_ptr<Table> table, const WhereClause& wc, std::vector<Row>& result,
+                    size_t maxRows = SIZE_MAX) {
+        std::vector<std::vector<size_t>> parts;
+        if (!matchRowParts(*table, wc, parts, maxRows)) return false;
+        materializeRows(*table, parts, result, maxRows);
+        return true;
+    }
+
+    // Materializes the rows listed in per-morsel id parts, keeping the first maxRows
+    void materializeRows(const Table& table, std::vector<std::vector<size_t>>& parts, std::vector<Row>& result,
+                         size_t maxRows = SIZE_MAX) {
+        // Drop whatever the last scanned morsels found beyond maxRows
+        size_t kept = 0;
+        for (auto& part : parts) {
+            if (part.size() > maxRows - kept) part.resize(maxRows - kept);
+            kept += part.size();
+        }
+
+        // Materialize each morsel's rows in parallel, then concatenate in order
+        std::vector<std::vector<Row>> rowParts(parts.size());
+        pool.parallelFor(parts.size(), [&](size_t p) {
+            rowParts[p].reserve(parts[p].size());
+            for (size_t i : parts[p]) {
+                rowParts[p].push_back(table.getRow(i));
+            }
+        });
+
+        size_t total = 0;
+        for (auto& part : rowParts) total += part.size();
+        result.reserve(total);
+        for (auto& part : rowParts) {
+            std::move(part.begin(), part.end(), std::back_inserter(result));
+        }
+    }
+
+    // Collects the ascending ids of the rows satisfying wc.
+    // Returns false if the clause cannot be bound.
+    bool matchRows(const Table& table, const WhereClause& wc, std::vector<size_t>& result) {
+        std::vector<std::vector<size_t>> parts;
+        if (!matchRowParts(table, wc, parts)) return false;
+        for (auto& part : parts) {
+            result.insert(result.end(), part.begin(), part.end());
+        }
+        return true;
+    }
+
+    // Like matchRows, but keeps the ids split into consecutive parts (one per scanned
+    // morsel). The clause is bound to the table once; equality leaves on indexed columns
+    // narrow the candidates through the hash index, otherwise the table is scanned in parallel.
+    // The parts hold at least the first maxRows matches (or all of them, if there are fewer).
+    bool matchRowParts(const Table& table, const WhereClause& wc, std::vector<std::vector<size_t>>& parts,
+                       size_t maxRows = SIZE_MAX) {
+        BoundExpression expr;
+        if (!expr.bind(wc, table)) return false;
+
+        std::vector<size_t> candidates;
+        if (expr.findIndexCandidates(table, candidates)) {
+            parts.emplace_back();
+            for (size_t i : candidates) {
+                if (parts.back().size() >= maxRows) break;
+                if (expr.evaluate(i)) parts.back().push_back(i);
+            }
+            return true;
+        }
+
+        parts = scanMorsels(table, expr, maxRows);
+        return true;
+    }
+
+    // Morsel-driven full scan: the table is cut into morsels of MORSEL_SIZE rows that the
+    // pool's threads evaluate independently, one vectorized batch at a time. Results stay
+    // per morsel, so concatenating them in morsel order reproduces the table's row order.
+    // With a bounded maxRows the morsels are scanned in waves of one morsel per thread,
+    // stopping after the wave in which the running total reaches maxRows.
+    std::vector<std::vector<size_t>> scanMorsels(const Table& table, const BoundExpression& expr,
+                                                 size_t maxRows = SIZE_MAX) {
+        size_t rowCount = table.rowCount();
+        size_t numMorsels = (rowCount + MORSEL_SIZE - 1) / MORSEL_SIZE;
+        std::vector<std::vector<size_t>> morselRows(numMorsels);
+
+        auto scanMorsel = [&](size_t m) {
+            size_t end = std::min((m + 1) * MORSEL_SIZE, rowCount);
+            uint64_t bitmap[BoundExpression::BATCH_WORDS];
+            for (size_t begin = m * MORSEL_SIZE; begin < end; begin += BoundExpression::BATCH_SIZE) {
+                size_t count = std::min(BoundExpression::BATCH_SIZE, end - begin);
+                expr.evaluateBatch(begin, count, bitmap);
+                BoundExpression::appendSelected(bitmap, begin, count, morselRows[m]);
+            }
+        };
+
+        if (maxRows == SIZE_MAX) {
+            pool.parallelFor(numMorsels, scanMorsel);
+            return morselRows;
+        }
+
+        size_t found = 0;
+        size_t scanned = 0;
+        while (scanned < numMorsels && found < maxRows) {
+            size_t wave = std::min(pool.size(), numMorsels - scanned);
+            pool.parallelFor(wave, [&](size_t w) { scanMorsel(scanned + w); });
+            for (size_t w = 0; w < wave; w++) found += morselRows[scanned + w].size();
+            scanned += wave;
+        }
+        morselRows.resize(scanned);
+        return morselRows;
+    }
+
+    // Joins the matching rows of the FROM table (ids in mainParts) with the join tables in the
+    // order chosen by JoinPlanner from the table sizes and distinct value estimates. Every
+    // intermediate result holds one row id per table joined so far instead of materialized
+    // rows. The result is then sorted back into the order the written joins produce (FROM
+    // rows in order, each followed by its matches in table order, join by join) and the first
+    // maxRows of it are materialized with the columns in written order.
+    // Returns false, leaving rows untouched, if the written order is the cheapest or a
+    // condition is not of the form "earlier_table.column = joined_table.column" over distinct
+    // tables; the caller then runs the joins as written.
+    bool joinInPlannedOrder(const std::shared_ptr<Database>& db, const std::shared_ptr<Table>& mainTable,
+                            const std::vector<SelectCommand::JoinClause>& joins,
+                            const std::vector<std::vector<size_t>>& mainParts, size_t maxRows,
+                            std::vector<Row>& rows) {
+        std::vector<std::shared_ptr<Table>> tables{mainTable};
+        std::vector<std::string> names{mainTable->getName()};
+        for (const auto& join : joins) {
+            auto table = db->getTable(join.tableName);
+            if (!table || std::find(names.begin(), names.end(), join.tableName) != names.end()) return false;
+            tables.push_back(table);
+            names.push_back(join.tableName);
+        }
+
+        std::vector<JoinEdge> edges(joins.size());
+        for (size_t j = 0; j < joins.size(); j++) {
+            if (!resolveJoinEdge(joins[j].condition, names, tables, j + 1, edges[j])) return false;
+        }
+
+        // Statistics: exact input sizes, distinct values of a join column capped by them
+        std::vector<double> inputRows(tables.size());
+        for (const auto& part : mainParts) inputRows[0] += (double)part.size();
+        for (size_t t = 1; t < tables.size(); t++) {
+            inputRows[t] = (double)(tables[t]->rowCount() - tables[t]->deletedRowCount());
+        }
+        for (auto& edge : edges) {
+            double left = std::min(inputRows[edge.left], (double)tables[edge.left]->distinctEstimate(edge.leftColumn));
+            double right = std::min(inputRows[edge.right], (double)tables[edge.right]->distinctEstimate(edge.rightColumn));
+            edge.selectivity = 1.0 / std::max({1.0, left, right});
+        }
+
+        std::vector<size_t> order = JoinPlanner(inputRows, edges).chooseOrder();
+        bool written = true;
+        for (size_t i = 0; i < order.size(); i++) written = written && order[i] == i;
+        if (written) return false;
+
+        // Tuples of `width` row ids, laid out one after another; slot[t] is the position of
+        // table t's row id within a tuple
+        auto inputIds = [&](size_t t) {
+            std::vector<size_t> ids;
+            if (t == 0) {
+                for (const auto& part : mainParts) ids.insert(ids.end(), part.begin(), part.end());
+            } else {
+                ids.reserve((size_t)inputRows[t]);
+                for (size_t r = 0; r < tables[t]->rowCount(); r++) {
+                    if (!tables[t]->isDeleted(r)) ids.push_back(r);
+                }
+            }
+            return ids;
+        };
+        std::vector<size_t> slot(tables.size());
+        std::vector<size_t> tuples = inputIds(order[0]);
+        slot[order[0]] = 0;
+        for (size_t width = 1; width < order.size(); width++) {
+            // The conditions form a tree, so exactly one of them links the next table to
+            // the tables joined so far
+            size_t next = order[width];
+            JoinEdge edge{};
+            for (const auto& e : edges) {
+                if (e.left != next && e.right != next) continue;
+                size_t other = e.left == next ? e.right : e.left;
+                if (std::find(order.begin(), order.begin() + width, other) == order.begin() + width) continue;
+                edge = e.right == next ? e : JoinEdge{e.right, e.rightColumn, e.left, e.leftColumn, e.selectivity};
+                break;
+            }
+            tuples = joinIds(tuples, width, slot[edge.left], tables[edge.left]->getColumns()[edge.leftColumn],
+                             inputIds(next), tables[next]->getColumns()[edge.rightColumn]);
+            slot[next] = width;
+        }
+
+        size_t width = tables.size();
+        size_t count = tuples.size() / width;
+        auto before = [&](size_t a, size_t b) {
+            for (size_t t = 0; t < width; t++) {
+                size_t x = tuples[a * width + slot[t]], y = tuples[b * width + slot[t]];
+                if (x != y) return x < y;
+            }
+            return false;
+        };
+        for (size_t i : topN(count, maxRows, before)) {
+            std::vector<Value> merged;
+            for (size_t t = 0; t < width; t++) {
+                for (const auto& col : tables[t]->getColumns()) merged.push_back(col.getValue(tuples[i * width + slot[t]]));
+            }
+            rows.emplace_back(std::move(merged));
+        }
+        return true;
+    }
+
+    // Resolves "A.x = B.y", the condition of the join that adds table `joined`, into an edge
+    // between the tables named A and B. B must be the joined table and A one before it.
+    static bool resolveJoinEdge(const std::string& condition, const std::vector<std::string>& names,
+                                const std::vector<std::shared_ptr<Table>>& tables, size_t joined, JoinEdge& edge) {
+        auto eqPos = condition.find('=');
+        if (eqPos == std::string::npos) return false;
+        std::string leftCond = trimStr(condition.substr(0, eqPos));
+        std::string rightCond = trimStr(condition.substr(eqPos + 1));
+        auto leftDot = leftCond.find('.');
+        auto rightDot = rightCond.find('.');
+        if (leftDot == std::string::npos || rightDot == std::string::npos) return false;
+        if (rightCond.substr(0, rightDot) != names[joined]) return false;
+
+        auto left = std::find(names.begin(), names.begin() + joined, leftCond.substr(0, leftDot));
+        if (left == names.begin() + joined) return false;
+        edge.left = left - names.begin();
+        edge.right = joined;
+        int leftColumn = tables[edge.left]->findColumnIndex(leftCond.substr(leftDot + 1));
+        int rightColumn = tables[joined]->findColumnIndex(rightCond.substr(rightDot + 1));
+        if (leftColumn == -1 || rightColumn == -1) return false;
+        edge.leftColumn = leftColumn;
+        edge.rightColumn = rightColumn;
+
+        bool leftText = tables[edge.left]->getColumns()[leftColumn].getType() == DataType::TEXT;
+        bool rightText = tables[joined]->getColumns()[rightColumn].getType() == DataType::TEXT;
+        return leftText == rightText;
+    }
+
+    // Joins tuples of `width` row ids with the rows `ids` of another table on
+    // leftCol[row id in tuple slot] = rightCol[row id], comparing keys as performJoin does.
+    // Appends the matching row id to each tuple; the output is in no particular order.
+    std::vector<size_t> joinIds(const std::vector<size_t>& tuples, size_t width, size_t leftSlot,
+                                const Column& leftCol, const std::vector<size_t>& ids, const Column& rightCol) {
+        auto leftRow = [&tuples, width, leftSlot](size_t i) { return tuples[i * width + leftSlot]; };
+        if (leftCol.getType() == DataType::TEXT) {
+            return hashJoinIds<std::string>(tuples, width, ids,
+                [&](size_t i) { return leftCol.getTexts()[leftRow(i)]; },
+                [&](size_t r) { return rightCol.getTexts()[r]; });
+        }
+        if (leftCol.getType() == DataType::INT && rightCol.getType() == DataType::INT) {
+            return hashJoinIds<int64_t>(tuples, width, ids,
+                [&](size_t i) { return leftCol.getInts()[leftRow(i)]; },
+                [&](size_t r) { return rightCol.getInts()[r]; });
+        }
+        return hashJoinIds<double>(tuples, width, ids,
+            [&](size_t i) { return normalizeKey(leftCol.getValue(leftRow(i)).asDouble()); },
+            [&](size_t r) { return normalizeKey(rightCol.getValue(r).asDouble()); });
+    }
+
+    // Hash join of tuples with row ids that builds on the smaller side
+    template <typename Key, typename LeftKeyFn, typename RightKeyFn>
+    static std::vector<size_t> hashJoinIds(const std::vector<size_t>& tuples, size_t width,
+                                           const std::vector<size_t>& ids, LeftKeyFn leftKey, RightKeyFn rightKey) {
+        size_t count = tuples.size() / width;
+        std::vector<size_t> result;
+        auto emit = [&](size_t i, size_t r) {
+            result.insert(result.end(), tuples.begin() + i * width, tuples.begin() + (i + 1) * width);
+            result.push_back(r);
+        };
+
+        std::unordered_map<Key, std::vector<size_t>> buckets;
+        if (ids.size() <= count) {
+            buckets.reserve(ids.size());
+            for (size_t r : ids) buckets[rightKey(r)].push_back(r);
+            for (size_t i = 0; i < count; i++) {
+                auto it = buckets.find(leftKey(i));
+                if (it == buckets.end()) continue;
+                for (size_t r : it->second) emit(i, r);
+            }
+        } else {
+            buckets.reserve(count);
+            for (size_t i = 0; i < count; i++) buckets[leftKey(i)].push_back(i);
+            for (size_t r : ids) {
+                auto it = buckets.find(rightKey(r));
+                if (it == buckets.end()) continue;
+                for (size_t i : it->second) emit(i, r);
             }
         }
         return result;
@@ -288,7 +1035,8 @@ private:
                                  const std::vector<DataType>& leftSchema,
                                  const std::vector<std::string>& leftColNames,
                                  std::shared_ptr<Table> rightTable,
-                                 const std::string& condition) {
+                                 const std::string& condition,
+                                 size_t maxRows = SIZE_MAX) {
         // Parse condition: "A.col = B.col"
         // Find '='
         auto eqPos = condition.find('=');
@@ -364,33 +1112,96 @@ private:
             return {};
         }
 
-        // Now perform nested loop join
-        std::vector<Row> result;
-        auto rightRows = rightTable->getRows();
-        for (auto& lRow : leftRows) {
-            auto lVals = lRow.getValues();
-            Value lVal = lVals[leftIndex];
-
-            for (auto& rRow : rightRows) {
-                auto rVals = rRow.getValues();
-                Value rVal = rVals[rightIndex];
-                if (lVal == rVal) {
-                    // Merge rows
-                    std::vector<DataType> mergedSchema = leftSchema;
-                    for (auto dt : rightTable->getTypeConfig()) {
-                        mergedSchema.push_back(dt);
-                    }
+        // Join keys are compared in a common representation: strings for TEXT, int64 when
+        // both sides are INT, otherwise double (INT promoted, as in Value comparisons)
+        DataType leftType = leftSchema[leftIndex];
+        DataType rightType = rightTable->getColumns()[rightIndex].getType();
+        if ((leftType == DataType::TEXT) != (rightType == DataType::TEXT)) {
+            std::cerr << "Cannot join columns of incompatible types: " << condition << "\n";
+            return {};
+        }
 
-                    std::vector<std::string> mergedRaw;
-                    for (auto& lv : lVals) mergedRaw.push_back(lv.getRawValue());
-                    for (auto& rv : rVals) mergedRaw.push_back(rv.getRawValue());
+        if (leftType == DataType::TEXT) {
+            return hashJoin<std::string>(leftRows, rightTable,
+                [leftIndex](const Row& r) { return r.getValue(leftIndex).getText(); },
+                [&col = rightTable->getColumns()[rightIndex]](size_t i) { return col.getTexts()[i]; }, maxRows);
+        }
+        if (leftType == DataType::INT && rightType == DataType::INT) {
+            return hashJoin<int64_t>(leftRows, rightTable,
+                [leftIndex](const Row& r) { return r.getValue(leftIndex).getInt(); },
+                [&col = rightTable->getColumns()[rightIndex]](size_t i) { return col.getInts()[i]; }, maxRows);
+        }
+        return hashJoin<double>(leftRows, rightTable,
+            [leftIndex](const Row& r) { return normalizeKey(r.getValue(leftIndex).asDouble()); },
+            [&col = rightTable->getColumns()[rightIndex]](size_t i) { return normalizeKey(col.getValue(i).asDouble()); },
+            maxRows);
+    }
+
+    // -0.0 and 0.0 compare equal, so they must hash equal
+    static double normalizeKey(double d) { return d == 0.0 ? 0.0 : d; }
 
-                    Row mergedRow(mergedSchema, mergedRaw);
-                    result.push_back(mergedRow);
+    // Hash join that builds on the smaller input and probes with the other one.
+    // Output order matches a nested loop: left rows in order, each followed by its
+    // matching right rows in table order. Runs in O(|L| + |R| + output).
+    // Emitting stops after maxRows output rows.
+    template <typename Key, typename LeftKeyFn, typename RightKeyFn>
+    std::vector<Row> hashJoin(const std::vector<Row>& leftRows,
+                              const std::shared_ptr<Table>& rightTable,
+                              LeftKeyFn leftKey,
+                              RightKeyFn rightKey,
+                              size_t maxRows = SIZE_MAX) {
+        size_t rightCount = rightTable->rowCount();
+        std::vector<Row> result;
+        const auto& rightCols = rightTable->getColumns();
+        auto emit = [&](size_t l, size_t r) {
+            std::vector<Value> merged = leftRows[l].getValues();
+            merged.reserve(merged.size() + rightCols.size());
+            for (const auto& col : rightCols) merged.push_back(col.getValue(r));
+            result.emplace_back(std::move(merged));
+        };
+
+        // Sides are compared by live rows: deleted rows are neither hashed nor probed
+        size_t rightLive = rightCount - rightTable->deletedRowCount();
+        if (rightLive <= leftRows.size()) {
+            // Build on the right table, then probe with the left rows in order and emit
+            // directly, so a bounded join stops probing once it has enough rows
+            std::unordered_map<Key, std::vector<size_t>> buckets;
+            buckets.reserve(rightLive);
+            for (size_t r = 0; r < rightCount; r++) {
+                if (!rightTable->isDeleted(r)) buckets[rightKey(r)].push_back(r);
+            }
+            for (size_t l = 0; l < leftRows.size() && result.size() < maxRows; l++) {
+                auto it = buckets.find(leftKey(leftRows[l]));
+                if (it == buckets.end()) continue;
+                for (size_t r : it->second) {
+                    if (result.size() >= maxRows) break;
+                    emit(l, r);
                 }
             }
+            return result;
         }
 
+        // Build on the left rows, probe with the right table
+        std::vector<std::vector<size_t>> matches(leftRows.size()); // left idx -> right row ids
+        std::unordered_map<Key, std::vector<size_t>> buckets;
+        buckets.reserve(leftRows.size());
+        for (size_t l = 0; l < leftRows.size(); l++) {
+            buckets[leftKey(leftRows[l])].push_back(l);
+        }
+        for (size_t r = 0; r < rightCount; r++) {
+            if (rightTable->isDeleted(r)) continue;
+            auto it = buckets.find(rightKey(r));
+            if (it == buckets.end()) continue;
+            for (size_t l : it->second) matches[l].push_back(r);
+        }
+
+        // Merge matching rows
+        for (size_t l = 0; l < leftRows.size() && result.size() < maxRows; l++) {
+            for (size_t r : matches[l]) {
+                if (result.size() >= maxRows) break;
+                emit(l, r);
+            }
+        }
         return result;
     }
 
@@ -426,38 +1237,35 @@ private:
 
         // Print header
         if (printAll) {
-            bool firstCol = true;
-            for (auto& cn : colNames) {
-                if (!firstCol) out << ",";
-                out << cn;
-                firstCol = false;
+            for (size_t i = 0; i < colNames.size(); i++) {
+                if (i > 0) writer.write(',');
+                writer.write(colNames[i]);
             }
-            out << "\n";
         } else {
             for (size_t i = 0; i < colIndexes.size(); i++) {
-                if (i > 0) out << ",";
-                out << colNames[colIndexes[i]];
+                if (i > 0) writer.write(',');
+                writer.write(colNames[colIndexes[i]]);
             }
-            out << "\n";
         }
+        writer.write('\n');
 
         // Print rows
         for (auto& r : rows) {
-            auto vals = r.getValues();
             if (printAll) {
-                for (size_t i = 0; i < vals.size(); i++) {
-                    if (i > 0) out << ",";
-                    printValueCSV(vals[i]);
+                for (size_t i = 0; i < r.size(); i++) {
+                    if (i > 0) writer.write(',');
+                    writer.writeValue(r.getValue(i));
                 }
             } else {
                 for (size_t i = 0; i < colIndexes.size(); i++) {
-                    if (i > 0) out << ",";
-                    printValueCSV(vals[colIndexes[i]]);
+                    if (i > 0) writer.write(',');
+                    writer.writeValue(r.getValue(colIndexes[i]));
                 }
             }
-            out << "\n";
+            writer.write('\n');
         }
-        out << "---\n";
+        writer.write("---\n");
+        writer.flush();
     }
 
     static std::string trimStr(const std::string& s) {
@@ -468,10 +1276,6 @@ private:
         return s.substr(start, end - start);
     }
 
-    void printValueCSV(const Value& v) {
-        out << v.getDisplayValue();
-    }
-
     int findJoinedColumnIndex(const std::vector<std::string>& allCols, const std::string& fullName) {
         for (int i = 0; i < (int)allCols.size(); i++) {
             if (allCols[i] == fullName) return i;
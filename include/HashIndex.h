@@ -0,0 +1,113 @@
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include "Utils.h"
+#include "Value.h"
+#include "Column.h"
+
+// In-memory hash index over one column: key -> ascending list of row ids.
+// Like Column, only the map matching the column type is used.
+class HashIndex {
+public:
+    HashIndex(std::string name, std::string columnName, size_t columnIdx, const DataType& type)
+        : name(std::move(name)), columnName(std::move(columnName)), columnIdx(columnIdx), type(type) {}
+
+    [[nodiscard]] const std::string& getName() const { return name; }
+    [[nodiscard]] const std::string& getColumnName() const { return columnName; }
+    [[nodiscard]] size_t getColumnIdx() const { return columnIdx; }
+
+    // Index every row currently stored in the column
+    void build(const Column& column) {
+        ints.clear();
+        floats.clear();
+        texts.clear();
+        for (size_t rowIdx = 0; rowIdx < column.size(); rowIdx++) {
+            insert(column.getValue(rowIdx), rowIdx);
+        }
+    }
+
+    void insert(const Value& key, size_t rowIdx) {
+        auto& ids = bucket(key);
+        ids.insert(std::lower_bound(ids.begin(), ids.end(), rowIdx), rowIdx);
+    }
+
+    void erase(const Value& key, size_t rowIdx) {
+        auto& ids = bucket(key);
+        auto it = std::lower_bound(ids.begin(), ids.end(), rowIdx);
+        if (it != ids.end() && *it == rowIdx) ids.erase(it);
+        if (ids.empty()) eraseBucket(key);
+    }
+
+    // Renumber the rows after a table compaction: row id i becomes newIds[i], ids mapped
+    // to SIZE_MAX are dropped. The mapping is increasing, so the lists stay sorted.
+    void remapRows(const std::vector<size_t>& newIds) {
+        auto remap = [&newIds](auto& map) {
+            for (auto it = map.begin(); it != map.end();) {
+                auto& ids = it->second;
+                size_t kept = 0;
+                for (size_t id : ids) {
+                    if (newIds[id] != SIZE_MAX) ids[kept++] = newIds[id];
+                }
+                ids.resize(kept);
+                it = ids.empty() ? map.erase(it) : std::next(it);
+            }
+        };
+        remap(ints);
+        remap(floats);
+        remap(texts);
+    }
+
+    // Returns the ascending row ids whose value equals key, or nullptr if none
+    [[nodiscard]] const std::vector<size_t>* lookup(const Value& key) const {
+        switch (type) {
+            case DataType::INT: {
+                auto it = ints.find(key.getInt());
+                return it == ints.end() ? nullptr : &it->second;
+            }
+            case DataType::FLOAT: {
+                auto it = floats.find(normalize(key.getFloat()));
+                return it == floats.end() ? nullptr : &it->second;
+            }
+            default: {
+                auto it = texts.find(key.getText());
+                return it == texts.end() ? nullptr : &it->second;
+            }
+        }
+    }
+
+private:
+    std::string name;
+    std::string columnName;
+    size_t columnIdx;
+    DataType type;
+    std::unordered_map<int64_t, std::vector<size_t>> ints;
+    std::unordered_map<double, std::vector<size_t>> floats;
+    std::unordered_map<std::string, std::vector<size_t>> texts;
+
+    // -0.0 and 0.0 compare equal, so they must share a bucket
+    static double normalize(double d) { return d == 0.0 ? 0.0 : d; }
+
+    std::vector<size_t>& bucket(const Value& key) {
+        switch (type) {
+            case DataType::INT: return ints[key.getInt()];
+            case DataType::FLOAT: return floats[normalize(key.getFloat())];
+            default: return texts[key.getText()];
+        }
+    }
+
+    void eraseBucket(const Value& key) {
+        switch (type) {
+            case DataType::INT: ints.erase(key.getInt()); break;
+            case DataType::FLOAT: floats.erase(normalize(key.getFloat())); break;
+            case DataType::TEXT: texts.erase(key.getText()); break;
+        }
+    }
+};
+
+#endif //HASHINDEX_H
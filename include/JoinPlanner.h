@@ -0,0 +1,178 @@
+#ifndef JOINPLANNER_H
+#define JOINPLANNER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+// Equi-join condition between two tables of a query. Tables are numbered by their position
+// in the statement: 0 is the FROM table, j + 1 the table of the j-th INNER JOIN.
+struct JoinEdge {
+    size_t left;
+    size_t leftColumn;
+    size_t right;
+    size_t rightColumn;
+    double selectivity = 1; // estimated fraction of the pairs of rows that match
+};
+
+// Chooses the order in which the tables of a join graph are joined. Joins run left-deep:
+// the result so far is hash joined with one more table that shares a condition with it,
+// so every order considered avoids cross products. The cost of an order is the number
+// of rows each join reads and produces, with
+//   |S joined with T| = |S| * |T| * selectivity of the conditions between S and T
+// and the selectivity of a condition a = b estimated as 1 / max(distinct(a), distinct(b)).
+// Up to MAX_EXHAUSTIVE_TABLES tables every connected order is costed by dynamic programming
+// over table subsets; larger queries start from the smallest table and add the table that
+// keeps the next result smallest.
+class JoinPlanner {
+public:
+    static constexpr size_t MAX_EXHAUSTIVE_TABLES = 12;
+
+    // rows[t]: estimated row count of table t (after its own filter)
+    JoinPlanner(std::vector<double> rows, std::vector<JoinEdge> edges)
+        : rows(std::move(rows)), edges(std::move(edges)) {}
+
+    // Cheapest order found; the written order 0, 1, ..., n - 1 unless another one is cheaper
+    [[nodiscard]] std::vector<size_t> chooseOrder() const {
+        std::vector<size_t> written(rows.size());
+        for (size_t t = 0; t < written.size(); t++) written[t] = t;
+        if (rows.size() <= 2) return written;
+
+        std::vector<size_t> best = rows.size() <= MAX_EXHAUSTIVE_TABLES ? exhaustiveOrder() : greedyOrder();
+        if (best.size() != rows.size() || cost(best) >= cost(written)) return written;
+        return best;
+    }
+
+    // Estimated cost of joining the tables in the given order (infinite if some table
+    // shares no condition with the ones before it)
+    [[nodiscard]] double cost(const std::vector<size_t>& order) const {
+        if (order.empty()) return 0;
+        double total = 0;
+        double card = rows[order[0]];
+        for (size_t i = 1; i < order.size(); i++) {
+            bool connected = false;
+            double next = card * rows[order[i]] * selectivityBetween(order[i], order.begin(), order.begin() + i, connected);
+            if (!connected) return std::numeric_limits<double>::infinity();
+            total += card + rows[order[i]] + next;
+            card = next;
+        }
+        return total;
+    }
+
+private:
+    std::vector<double> rows;
+    std::vector<JoinEdge> edges;
+
+    // Product of the selectivities of the conditions between t and the tables in [begin, end)
+    template <typename It>
+    double selectivityBetween(size_t t, It begin, It end, bool& connected) const {
+        double selectivity = 1;
+        for (const auto& edge : edges) {
+            size_t other;
+            if (edge.left == t) other = edge.right;
+            else if (edge.right == t) other = edge.left;
+            else continue;
+            for (It it = begin; it != end; ++it) {
+                if (*it == other) {
+                    selectivity *= edge.selectivity;
+                    connected = true;
+                    break;
+                }
+            }
+        }
+        return selectivity;
+    }
+
+    double selectivityBetween(size_t t, uint32_t set, bool& connected) const {
+        double selectivity = 1;
+        for (const auto& edge : edges) {
+            size_t other;
+            if (edge.left == t) other = edge.right;
+            else if (edge.right == t) other = edge.left;
+            else continue;
+            if (set >> other & 1) {
+                selectivity *= edge.selectivity;
+                connected = true;
+            }
+        }
+        return selectivity;
+    }
+
+    // best[S]: cheapest way to join the tables of S, ending with table last[S]
+    std::vector<size_t> exhaustiveOrder() const {
+        size_t n = rows.size();
+        uint32_t full = (uint32_t(1) << n) - 1;
+        std::vector<double> card(full + 1), best(full + 1, std::numeric_limits<double>::infinity());
+        std::vector<size_t> last(full + 1, SIZE_MAX);
+
+        card[0] = 1;
+        for (uint32_t set = 1; set <= full; set++) {
+            size_t t = 0;
+            while (!(set >> t & 1)) t++;
+            uint32_t rest = set & (set - 1);
+            bool connected = false;
+            card[set] = card[rest] * rows[t] * selectivityBetween(t, rest, connected);
+            if (rest == 0) {
+                best[set] = 0;
+                last[set] = t;
+            }
+        }
+
+        for (uint32_t set = 1; set <= full; set++) {
+            if ((set & (set - 1)) == 0) continue;
+            for (size_t t = 0; t < n; t++) {
+                if (!(set >> t & 1)) continue;
+                uint32_t rest = set & ~(uint32_t(1) << t);
+                bool connected = false;
+                selectivityBetween(t, rest, connected);
+                if (!connected || best[rest] == std::numeric_limits<double>::infinity()) continue;
+                double c = best[rest] + card[rest] + rows[t] + card[set];
+                if (c < best[set]) {
+                    best[set] = c;
+                    last[set] = t;
+                }
+            }
+        }
+
+        std::vector<size_t> order;
+        for (uint32_t set = full; set != 0 && last[set] != SIZE_MAX; set &= ~(uint32_t(1) << last[set])) {
+            order.push_back(last[set]);
+        }
+        return {order.rbegin(), order.rend()};
+    }
+
+    std::vector<size_t> greedyOrder() const {
+        size_t n = rows.size();
+        std::vector<size_t> order;
+        std::vector<bool> used(n, false);
+        size_t first = 0;
+        for (size_t t = 1; t < n; t++) {
+            if (rows[t] < rows[first]) first = t;
+        }
+        order.push_back(first);
+        used[first] = true;
+
+        double card = rows[first];
+        while (order.size() < n) {
+            size_t pick = SIZE_MAX;
+            double pickCard = 0;
+            for (size_t t = 0; t < n; t++) {
+                if (used[t]) continue;
+                bool connected = false;
+                double next = card * rows[t] * selectivityBetween(t, order.begin(), order.end(), connected);
+                if (connected && (pick == SIZE_MAX || next < pickCard)) {
+                    pick = t;
+                    pickCard = next;
+                }
+            }
+            if (pick == SIZE_MAX) break; // disconnected graph: keep the written order
+            order.push_back(pick);
+            used[pick] = true;
+            card = pickCard;
+        }
+        return order;
+    }
+};
+
+#endif //JOINPLANNER_H
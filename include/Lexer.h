@@ -0,0 +1,144 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <cctype>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+enum class TokenKind {
+    WORD,    // identifier or keyword, possibly qualified (table.column) or "*"
+    NUMBER,  // integer or decimal literal, optionally signed
+    STRING,  // quoted literal; text keeps the quotes
+    SYMBOL,  // ( ) , ; = <> != < > <= >=
+    END,
+};
+
+// Keywords are recognized case-insensitively; any other word is Keyword::NONE
+enum class Keyword {
+    NONE,
+    AND, ASC, BY, COPY, CREATE, DATABASE, DELETE, DESC, DROP, DURABILITY, FROM, GROUP, HEADER,
+    INDEX, INNER, INSERT, INTO, JOIN, LIMIT, OFFSET, ON, OR, ORDER, SELECT, SET, TABLE, UPDATE, USE,
+    USING, VACUUM, VALUES, WHERE,
+};
+
+struct Token {
+    TokenKind kind;
+    std::string_view text; // view into the statement being parsed
+    Keyword keyword = Keyword::NONE;
+
+    [[nodiscard]] bool is(Keyword k) const { return kind == TokenKind::WORD && keyword == k; }
+    [[nodiscard]] bool is(char symbol) const { return kind == TokenKind::SYMBOL && text.size() == 1 && text[0] == symbol; }
+
+    // Text of a STRING token without its quotes, any other token's text as is
+    [[nodiscard]] std::string_view unquoted() const {
+        return kind == TokenKind::STRING ? text.substr(1, text.size() - 2) : text;
+    }
+};
+
+// Single pass over a statement producing tokens that point into it, so nothing is copied
+// or upper-cased. The statement must outlive the tokens.
+class Lexer {
+public:
+    // Tokens of `sql`, terminated by an END token. Returns false (with `error` set to the
+    // offending position) on an unterminated string literal.
+    static bool tokenize(std::string_view sql, std::vector<Token>& tokens, size_t& error) {
+        tokens.clear();
+        size_t i = 0;
+        while (true) {
+            while (i < sql.size() && std::isspace((unsigned char)sql[i])) i++;
+            if (i == sql.size()) break;
+
+            size_t start = i;
+            char c = sql[i];
+            if (c == '\'' || c == '"') {
+                size_t close = sql.find(c, i + 1);
+                if (close == std::string_view::npos) {
+                    error = start;
+                    return false;
+                }
+                i = close + 1;
+                tokens.push_back({TokenKind::STRING, sql.substr(start, i - start)});
+            } else if (c == '(' || c == ')' || c == ',' || c == ';' || c == '=') {
+                i++;
+                tokens.push_back({TokenKind::SYMBOL, sql.substr(start, 1)});
+            } else if (c == '<' || c == '>' || c == '!') {
+                i++;
+                if (i < sql.size() && (sql[i] == '=' || (c == '<' && sql[i] == '>'))) i++;
+                tokens.push_back({TokenKind::SYMBOL, sql.substr(start, i - start)});
+            } else {
+                // A word runs until whitespace, a quote or a symbol
+                while (i < sql.size() && !isDelimiter(sql[i])) i++;
+                std::string_view word = sql.substr(start, i - start);
+                if (isNumber(word)) tokens.push_back({TokenKind::NUMBER, word});
+                else tokens.push_back({TokenKind::WORD, word, classify(word)});
+            }
+        }
+        tokens.push_back({TokenKind::END, sql.substr(sql.size())});
+        return true;
+    }
+
+    // Keyword::NONE unless `word` is a keyword in any letter case
+    static Keyword classify(std::string_view word) {
+        struct Entry { std::string_view name; Keyword keyword; };
+        static constexpr Entry KEYWORDS[] = {
+            {"AND", Keyword::AND}, {"ASC", Keyword::ASC}, {"BY", Keyword::BY},
+            {"COPY", Keyword::COPY}, {"CREATE", Keyword::CREATE}, {"DATABASE", Keyword::DATABASE},
+            {"DELETE", Keyword::DELETE}, {"DESC", Keyword::DESC}, {"DROP", Keyword::DROP},
+            {"DURABILITY", Keyword::DURABILITY}, {"FROM", Keyword::FROM}, {"GROUP", Keyword::GROUP},
+            {"HEADER", Keyword::HEADER}, {"INDEX", Keyword::INDEX}, {"INNER", Keyword::INNER},
+            {"INSERT", Keyword::INSERT}, {"INTO", Keyword::INTO}, {"JOIN", Keyword::JOIN},
+            {"LIMIT", Keyword::LIMIT}, {"OFFSET", Keyword::OFFSET}, {"ON", Keyword::ON}, {"OR", Keyword::OR},
+            {"ORDER", Keyword::ORDER}, {"SELECT", Keyword::SELECT}, {"SET", Keyword::SET},
+            {"TABLE", Keyword::TABLE}, {"UPDATE", Keyword::UPDATE}, {"USE", Keyword::USE},
+            {"USING", Keyword::USING}, {"VACUUM", Keyword::VACUUM}, {"VALUES", Keyword::VALUES},
+            {"WHERE", Keyword::WHERE},
+        };
+        if (word.size() < 2 || word.size() > 10) return Keyword::NONE;
+        for (const auto& entry : KEYWORDS) {
+            if (entry.name.size() == word.size() && equalsIgnoreCase(word, entry.name)) return entry.keyword;
+        }
+        return Keyword::NONE;
+    }
+
+private:
+    static bool isDelimiter(char c) {
+        switch (c) {
+            case '\'': case '"': case '(': case ')': case ',': case ';': case '=': case '<': case '>': case '!':
+                return true;
+            default:
+                return std::isspace((unsigned char)c) != 0;
+        }
+    }
+
+    // [+-]digits[.digits] or [+-].digits, with an optional exponent
+    static bool isNumber(std::string_view word) {
+        size_t i = 0;
+        if (i < word.size() && (word[i] == '+' || word[i] == '-')) i++;
+        size_t digits = 0;
+        while (i < word.size() && std::isdigit((unsigned char)word[i])) i++, digits++;
+        if (i < word.size() && word[i] == '.') {
+            i++;
+            while (i < word.size() && std::isdigit((unsigned char)word[i])) i++, digits++;
+        }
+        if (digits == 0) return false;
+        if (i < word.size() && (word[i] == 'e' || word[i] == 'E')) {
+            i++;
+            if (i < word.size() && (word[i] == '+' || word[i] == '-')) i++;
+            size_t exponent = 0;
+            while (i < word.size() && std::isdigit((unsigned char)word[i])) i++, exponent++;
+            if (exponent == 0) return false;
+        }
+        return i == word.size();
+    }
+
+    // `upper` is an upper-case keyword
+    static bool equalsIgnoreCase(std::string_view word, std::string_view upper) {
+        for (size_t i = 0; i < word.size(); i++) {
+            if (std::toupper((unsigned char)word[i]) != upper[i]) return false;
+        }
+        return true;
+    }
+};
+
+#endif //LEXER_H
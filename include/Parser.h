@@ -6,538 +6,574 @@
 #define PARSER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
-#include <sstream>
-#include <fstream>
+#include <iostream>
 #include <algorithm>
 #include <cctype>
 #include "Comands.h"
+#include "Condition.h"
+#include "Lexer.h"
 #include "Utils.h"
+#include "Value.h"
 
 
+// Recursive-descent SQL parser over the tokens of one statement (see Lexer). Each
+// parseX function consumes its statement from a Cursor and reports the first syntax
+// error on std::cerr, returning nullptr. WHERE clauses are parsed straight into an
+// ExpressionNode tree with the usual precedence: OR < AND < comparison / parentheses.
 class Parser {
 public:
     Parser() = default;
 
-    // Parse a single command string into a Command object
+    // Parse a single command string (with or without its ';') into a Command object
     static std::unique_ptr<Command> parse(const std::string& query) {
-        std::string trimmed = trim(query);
-        if (trimmed.empty()) return nullptr;
-
-        std::vector<std::string> tokens = tokenize(trimmed);
-        if (tokens.empty()) {
+        thread_local std::vector<Token> tokens; // reused across statements of a thread
+        size_t errorPos = 0;
+        if (!Lexer::tokenize(query, tokens, errorPos)) {
+            std::cerr << "Unterminated string literal in: " << trim(query) << std::endl;
             return nullptr;
         }
+        if (tokens.size() == 1) return nullptr; // empty statement
 
-        std::vector<std::string> upperTokens = tokens;
-        for (auto &t : upperTokens) {
-            t = toUpper(t);
-        }
-
-        // Identify the command type
-        if (upperTokens.size() >= 2 && upperTokens[0] == "CREATE" && upperTokens[1] == "DATABASE") {
-            return parseCreateDatabase(tokens);
-        } else if (upperTokens.size() >= 2 && upperTokens[0] == "USE" && upperTokens[1] == "DATABASE") {
-            return parseUseDatabase(tokens);
-        } else if (upperTokens.size() >= 3 && upperTokens[0] == "CREATE" && upperTokens[1] == "TABLE") {
-            return parseCreateTable(tokens);
-        } else if (upperTokens.size() >= 3 && upperTokens[0] == "DROP" && upperTokens[1] == "TABLE") {
-            return parseDropTable(tokens);
-        } else if (upperTokens.size() >= 4 && upperTokens[0] == "INSERT" && upperTokens[1] == "INTO") {
-            return parseInsert(tokens);
-        } else if (!upperTokens.empty() && upperTokens[0] == "SELECT") {
-            return parseSelect(tokens, upperTokens);
-        } else if (!upperTokens.empty() && upperTokens[0] == "UPDATE") {
-            return parseUpdate(tokens, upperTokens);
-        } else if (upperTokens.size() >= 3 && upperTokens[0] == "DELETE" && upperTokens[1] == "FROM") {
-            return parseDelete(tokens, upperTokens);
+        Cursor c{tokens};
+        const Token& first = c.peek();
+        switch (first.keyword) {
+            case Keyword::CREATE:
+                if (c.peek(1).is(Keyword::DATABASE)) return parseCreateDatabase(c);
+                if (c.peek(1).is(Keyword::TABLE)) return parseCreateTable(c);
+                if (c.peek(1).is(Keyword::INDEX)) return parseCreateIndex(c);
+                break;
+            case Keyword::USE: return parseUseDatabase(c);
+            case Keyword::DROP: return parseDropTable(c);
+            case Keyword::INSERT: return parseInsert(c);
+            case Keyword::SELECT: return parseSelect(c);
+            case Keyword::UPDATE: return parseUpdate(c);
+            case Keyword::DELETE: return parseDelete(c);
+            case Keyword::COPY: return parseCopy(c);
+            case Keyword::SET: return parseSetDurability(c);
+            case Keyword::VACUUM: return parseVacuum(c);
+            default: break;
         }
 
         // Unrecognized command
-        std::cerr << "Unrecognized or unsupported command: " << query << std::endl;
+        std::cerr << "Unrecognized or unsupported command: " << trim(query) << std::endl;
         return nullptr;
     }
 
-    // Parse multiple commands from a single string (e.g., the contents of a file)
-    // Commands are assumed to be separated by semicolons, but semicolons within quotes are ignored.
-    static std::vector<std::unique_ptr<Command>> parseMultiple(const std::string& content) {
-        std::vector<std::unique_ptr<Command>> commands;
-        std::vector<std::string> statements = splitBySemicolon(content);
+private:
+    // Read position in a statement's tokens; the last token is always END
+    struct Cursor {
+        const std::vector<Token>& tokens;
+        size_t pos = 0;
+
+        [[nodiscard]] const Token& peek(size_t ahead = 0) const {
+            return tokens[std::min(pos + ahead, tokens.size() - 1)];
+        }
 
-        for (auto &stmt : statements) {
-            auto cmd = parse(stmt);
-            if (cmd) {
-                commands.push_back(std::move(cmd));
-            }
+        const Token& next() {
+            const Token& token = tokens[pos];
+            if (token.kind != TokenKind::END) pos++;
+            return token;
+        }
+
+        bool accept(Keyword keyword) {
+            if (!peek().is(keyword)) return false;
+            pos++;
+            return true;
         }
 
-        return commands;
+        bool accept(char symbol) {
+            if (!peek().is(symbol)) return false;
+            pos++;
+            return true;
+        }
+    };
+
+    static void syntaxError(const Token& at, const std::string& expected) {
+        std::cerr << "Syntax error: expected " << expected;
+        if (at.kind == TokenKind::END) std::cerr << " at end of statement\n";
+        else std::cerr << " near '" << at.text << "'\n";
+    }
+
+    static bool expect(Cursor& c, Keyword keyword, const char* text) {
+        if (c.accept(keyword)) return true;
+        syntaxError(c.peek(), text);
+        return false;
+    }
+
+    static bool expect(Cursor& c, char symbol) {
+        if (c.accept(symbol)) return true;
+        syntaxError(c.peek(), std::string("'") + symbol + "'");
+        return false;
     }
 
-    // Parse multiple commands from a file
-    static std::vector<std::unique_ptr<Command>> parseFile(const std::string& filename) {
-        std::ifstream ifs(filename);
-        if (!ifs.is_open()) {
-            std::cerr << "Error opening file: " << filename << "\n";
-            return {};
+    // Identifier (table, column, index or database name)
+    static bool expectName(Cursor& c, std::string& out, const char* what) {
+        if (c.peek().kind != TokenKind::WORD) {
+            syntaxError(c.peek(), what);
+            return false;
         }
+        out = std::string(c.next().text);
+        return true;
+    }
 
-        std::stringstream buffer;
-        buffer << ifs.rdbuf();
-        std::string fileContent = buffer.str();
-        return parseMultiple(fileContent);
+    // Literal value (number, quoted string or bare word); quotes are kept only if keepQuotes
+    static bool expectValue(Cursor& c, std::string& out, bool keepQuotes) {
+        const Token& token = c.peek();
+        if (token.kind != TokenKind::NUMBER && token.kind != TokenKind::STRING && token.kind != TokenKind::WORD) {
+            syntaxError(token, "a value");
+            return false;
+        }
+        c.next();
+        out = std::string(keepQuotes ? token.text : token.unquoted());
+        return true;
+    }
+
+    // Optional ';', then the end of the statement
+    static bool finish(Cursor& c) {
+        c.accept(';');
+        if (c.peek().kind == TokenKind::END) return true;
+        syntaxError(c.peek(), "end of statement");
+        return false;
     }
 
-private:
     // Parse functions for each command type
-    static std::unique_ptr<Command> parseCreateDatabase(const std::vector<std::string>& tokens) {
+    static std::unique_ptr<Command> parseCreateDatabase(Cursor& c) {
         // CREATE DATABASE database_name;
-        if (tokens.size() < 3) {
+        c.pos += 2;
+        std::string dbName;
+        if (c.peek().kind != TokenKind::WORD) {
             std::cerr << "CREATE DATABASE command requires a database name.\n";
             return nullptr;
         }
-        std::string dbName = stripSemicolon(tokens[2]);
+        if (!expectName(c, dbName, "a database name") || !finish(c)) return nullptr;
         return std::make_unique<CreateDatabaseCommand>(dbName);
     }
 
-    static std::unique_ptr<Command> parseUseDatabase(const std::vector<std::string>& tokens) {
+    static std::unique_ptr<Command> parseUseDatabase(Cursor& c) {
         // USE DATABASE database_name;
-        if (tokens.size() < 3) {
+        c.pos++;
+        std::string dbName;
+        if (!expect(c, Keyword::DATABASE, "DATABASE")) return nullptr;
+        if (c.peek().kind != TokenKind::WORD) {
             std::cerr << "USE DATABASE command requires a database name.\n";
             return nullptr;
         }
-        std::string dbName = stripSemicolon(tokens[2]);
+        if (!expectName(c, dbName, "a database name") || !finish(c)) return nullptr;
         return std::make_unique<UseDatabaseCommand>(dbName);
     }
 
-    static std::unique_ptr<Command> parseCreateTable(const std::vector<std::string>& tokens) {
+    static std::unique_ptr<Command> parseCreateTable(Cursor& c) {
         // CREATE TABLE table_name ( col_name type, col_name type, ... );
-
-        if (tokens.size() < 4) {
-            std::cerr << "CREATE TABLE command requires a table name and column definitions.\n";
+        c.pos += 2;
+        std::string tableName;
+        if (!expectName(c, tableName, "a table name")) return nullptr;
+        if (!c.accept('(')) {
+            std::cerr << "Malformed CREATE TABLE command: Missing or misplaced parentheses.\n";
             return nullptr;
         }
 
-        std::string tableName = tokens[2];
         std::vector<std::pair<std::string, DataType>> columns;
-
-        // Find the opening and closing parentheses
-        int openParen = -1, closeParen = -1;
-        for (size_t i = 3; i < tokens.size(); ++i) {
-            if (tokens[i] == "(") {
-                openParen = i;
-            }
-            if (tokens[i] == ")") {
-                closeParen = i;
-                break;
+        do {
+            std::string colName, typeName;
+            if (!expectName(c, colName, "a column name") || !expectName(c, typeName, "a column type")) return nullptr;
+            try {
+                columns.emplace_back(colName, stringToDataType(toUpper(typeName)));
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "Error in CREATE TABLE: " << e.what() << std::endl;
+                return nullptr;
             }
-        }
+        } while (c.accept(','));
 
-        if (openParen == -1 || closeParen == -1 || closeParen <= openParen) {
-            std::cerr << "Malformed CREATE TABLE command: Missing or misplaced parentheses.\n";
-            return nullptr;
-        }
+        if (!expect(c, ')') || !finish(c)) return nullptr;
+        return std::make_unique<CreateTableCommand>(tableName, columns);
+    }
 
-        // Extract column definitions between parentheses
-        std::vector<std::string> colDefs;
-        for (size_t i = openParen + 1; i < closeParen; ++i) {
-            if (tokens[i] == ",") continue; // Skip commas
-            colDefs.push_back(tokens[i]);
+    static std::unique_ptr<Command> parseCreateIndex(Cursor& c) {
+        // CREATE INDEX index_name ON table_name ( column_name ) [USING HASH | BTREE];
+        c.pos += 2;
+        std::string indexName, tableName, columnName;
+        if (c.peek().kind != TokenKind::WORD || !c.peek(1).is(Keyword::ON) || c.peek(2).kind != TokenKind::WORD
+            || !c.peek(3).is('(') || c.peek(4).kind != TokenKind::WORD || !c.peek(5).is(')')) {
+            std::cerr << "Malformed CREATE INDEX command: expected CREATE INDEX name ON table(column) [USING HASH|BTREE].\n";
+            return nullptr;
         }
-
-        // Process column definitions as pairs: name and type
-        for (size_t i = 0; i + 1 < colDefs.size(); i += 2) {
-            std::string colName = colDefs[i];
-            std::string typeStr = colDefs[i + 1];
+        expectName(c, indexName, "an index name");
+        c.next();
+        expectName(c, tableName, "a table name");
+        c.next();
+        expectName(c, columnName, "a column name");
+        c.next();
+
+        IndexKind kind = IndexKind::HASH;
+        if (c.accept(Keyword::USING)) {
+            std::string kindName;
+            if (!expectName(c, kindName, "HASH or BTREE")) return nullptr;
             try {
-                DataType dt = stringToDataType(typeStr);
-                columns.emplace_back(colName, dt);
+                kind = stringToIndexKind(toUpper(kindName));
             } catch (const std::invalid_argument& e) {
-                std::cerr << "Error in CREATE TABLE: " << e.what() << std::endl;
+                std::cerr << e.what() << "\n";
                 return nullptr;
             }
         }
+        if (!finish(c)) return nullptr;
+        return std::make_unique<CreateIndexCommand>(indexName, tableName, columnName, kind);
+    }
 
-        return std::make_unique<CreateTableCommand>(tableName, columns);
+    static std::unique_ptr<Command> parseSetDurability(Cursor& c) {
+        // SET DURABILITY [=] sync|group|off;
+        c.pos++;
+        if (!c.accept(Keyword::DURABILITY)) {
+            std::cerr << "Unsupported SET command: only SET DURABILITY is supported.\n";
+            return nullptr;
+        }
+        c.accept('=');
+        if (c.peek().kind != TokenKind::WORD) {
+            std::cerr << "SET DURABILITY requires a mode: sync, group or off.\n";
+            return nullptr;
+        }
+        std::string mode(c.next().text);
+        std::transform(mode.begin(), mode.end(), mode.begin(), [](unsigned char ch) { return std::tolower(ch); });
+        if (!finish(c)) return nullptr;
+        return std::make_unique<SetDurabilityCommand>(mode);
     }
 
-    static std::unique_ptr<Command> parseDropTable(const std::vector<std::string>& tokens) {
+    static std::unique_ptr<Command> parseDropTable(Cursor& c) {
         // DROP TABLE table_name;
-        if (tokens.size() < 3) {
+        c.pos++;
+        std::string tblName;
+        if (!expect(c, Keyword::TABLE, "TABLE")) return nullptr;
+        if (c.peek().kind != TokenKind::WORD) {
             std::cerr << "DROP TABLE command requires a table name.\n";
             return nullptr;
         }
-        std::string tblName = stripSemicolon(tokens[2]);
+        if (!expectName(c, tblName, "a table name") || !finish(c)) return nullptr;
         return std::make_unique<DropTableCommand>(tblName);
     }
 
-    static std::unique_ptr<Command> parseInsert(const std::vector<std::string>& tokens) {
-        // INSERT INTO table_name VALUES (val1, val2, ...);
-        if (tokens.size() < 4) {
-            std::cerr << "INSERT INTO command requires a table name and values.\n";
-            return nullptr;
-        }
-
-        std::string tableName = tokens[2];
-        std::vector<std::string> values;
-
-        // Find the opening and closing parentheses after VALUES
-        size_t valuesIndex = 3;
-        while (valuesIndex < tokens.size() && toUpper(tokens[valuesIndex]) != "VALUES") {
-            ++valuesIndex;
-        }
+    static std::unique_ptr<Command> parseVacuum(Cursor& c) {
+        // VACUUM [table_name];
+        c.pos++;
+        std::string tblName;
+        if (c.peek().kind == TokenKind::WORD) tblName = std::string(c.next().text);
+        if (!finish(c)) return nullptr;
+        return std::make_unique<VacuumCommand>(tblName);
+    }
 
-        if (valuesIndex == tokens.size()) {
+    static std::unique_ptr<Command> parseInsert(Cursor& c) {
+        // INSERT INTO table_name VALUES (val1, val2, ...) [, (val1, val2, ...) ...];
+        c.pos++;
+        std::string tableName;
+        if (!expect(c, Keyword::INTO, "INTO") || !expectName(c, tableName, "a table name")) return nullptr;
+        if (!c.accept(Keyword::VALUES)) {
             std::cerr << "INSERT INTO command missing VALUES keyword.\n";
             return nullptr;
         }
 
-        // Expect '(' after VALUES
-        if (valuesIndex + 1 >= tokens.size() || tokens[valuesIndex + 1] != "(") {
-            std::cerr << "INSERT INTO command expects '(' after VALUES.\n";
-            return nullptr;
-        }
+        // Each tuple is '(' values ')', tuples are separated by ','
+        std::vector<std::vector<std::string>> rows;
+        do {
+            if (!c.accept('(')) {
+                std::cerr << "INSERT INTO command expects '(' after VALUES.\n";
+                return nullptr;
+            }
+            std::vector<std::string> values;
+            if (!c.peek().is(')')) {
+                do {
+                    std::string value;
+                    if (!expectValue(c, value, false)) return nullptr;
+                    values.push_back(std::move(value));
+                } while (c.accept(','));
+            }
+            if (!c.accept(')')) {
+                std::cerr << "INSERT INTO command missing closing ')'.\n";
+                return nullptr;
+            }
+            rows.push_back(std::move(values));
+        } while (c.accept(','));
 
-        // Find closing ')'
-        size_t openParen = valuesIndex + 1;
-        size_t closeParen = openParen;
-        while (closeParen < tokens.size() && tokens[closeParen] != ")") {
-            ++closeParen;
-        }
+        if (!finish(c)) return nullptr;
+        return std::make_unique<InsertCommand>(tableName, std::move(rows));
+    }
 
-        if (closeParen == tokens.size()) {
-            std::cerr << "INSERT INTO command missing closing ')'.\n";
+    static std::unique_ptr<Command> parseCopy(Cursor& c) {
+        // COPY table_name FROM 'file.csv' [HEADER];
+        c.pos++;
+        std::string tableName;
+        if (c.peek().kind != TokenKind::WORD || !c.peek(1).is(Keyword::FROM) || c.peek(2).kind != TokenKind::STRING) {
+            std::cerr << "COPY command expects: COPY table_name FROM 'file.csv' [HEADER];\n";
             return nullptr;
         }
-
-        // Extract values between parentheses
-        for (size_t i = openParen + 1; i < closeParen; ++i) {
-            if (tokens[i] == ",") continue; // Skip commas
-            std::string val = tokens[i];
-            // Remove surrounding quotes if present
-            if (isQuoted(val)) {
-                val = unquote(val);
-            }
-            values.push_back(val);
-        }
-
-        return std::make_unique<InsertCommand>(tableName, values);
+        expectName(c, tableName, "a table name");
+        c.next();
+        std::string path(c.next().unquoted());
+        bool header = c.accept(Keyword::HEADER);
+        if (!finish(c)) return nullptr;
+        return std::make_unique<CopyCommand>(tableName, path, header);
     }
 
-    static std::unique_ptr<Command> parseSelect(const std::vector<std::string>& tokens, const std::vector<std::string>& upperTokens) {
-        // Similar to your current code
+    static std::unique_ptr<Command> parseSelect(Cursor& c) {
+        // SELECT items FROM table [INNER JOIN table ON a.x = b.y ...] [WHERE expr]
+        //        [GROUP BY cols] [ORDER BY keys] [LIMIT n [OFFSET m]];
+        c.pos++;
         std::vector<std::string> columns;
         std::string tableName;
-        std::string whereClause;
 
-        // This will store multiple joins
-        std::vector<SelectCommand::JoinClause> joins;
+        // Select list; FUNC ( arg ) is an aggregate
+        std::vector<SelectCommand::Aggregate> aggregates;
+        bool hasAggregate = false;
+        do {
+            std::string col;
+            if (!expectName(c, col, "a column")) return nullptr;
+            if (c.accept('(')) {
+                std::string function = toUpper(col);
+                std::string arg;
+                if (!isAggregateFunction(function) || c.peek().kind != TokenKind::WORD || !c.peek(1).is(')')) {
+                    std::cerr << "Malformed aggregate in SELECT: " << col << "\n";
+                    return nullptr;
+                }
+                expectName(c, arg, "a column");
+                c.next();
+                if (arg == "*" && function != "COUNT") {
+                    std::cerr << function << "(*) is not supported.\n";
+                    return nullptr;
+                }
+                columns.push_back(function + "(" + arg + ")");
+                aggregates.push_back({function, arg});
+                hasAggregate = true;
+            } else {
+                columns.push_back(col);
+                aggregates.push_back({"", col});
+            }
+        } while (c.accept(','));
+        if (!hasAggregate) aggregates.clear();
 
-        // Find FROM index
-        size_t fromIndex = findToken(upperTokens, "FROM");
-        if (fromIndex == std::string::npos || fromIndex + 1 >= tokens.size()) {
+        if (!c.accept(Keyword::FROM)) {
             std::cerr << "SELECT command missing FROM clause.\n";
             return nullptr;
         }
+        if (!expectName(c, tableName, "a table name")) return nullptr;
 
-        // Columns are between SELECT and FROM
-        for (size_t i = 1; i < fromIndex; ++i) {
-            std::string col = stripComma(tokens[i]);
-            if (!col.empty()) columns.push_back(col);
-        }
-
-        // Next token after FROM is table name
-        tableName = stripSemicolon(stripComma(tokens[fromIndex + 1]));
-
-        size_t currentIndex = fromIndex + 2;
-        // Now parse multiple JOIN clauses
-        while (currentIndex < tokens.size()) {
-            // Look for INNER JOIN
-            size_t innerIndex = findToken(upperTokens, "INNER", currentIndex);
-            if (innerIndex == std::string::npos) {
-                // No more INNER JOINs, break out
-                break;
-            }
-            // Ensure next token is JOIN
-            if (innerIndex + 1 >= tokens.size() || toUpper(tokens[innerIndex + 1]) != "JOIN") {
-                // Malformed syntax
+        // [INNER] JOIN table ON left = right, any number of times
+        std::vector<SelectCommand::JoinClause> joins;
+        while (c.peek().is(Keyword::INNER) || c.peek().is(Keyword::JOIN)) {
+            if (c.accept(Keyword::INNER) && !c.peek().is(Keyword::JOIN)) {
                 std::cerr << "Expected JOIN after INNER.\n";
                 return nullptr;
             }
-
-            // Extract join table
-            if (innerIndex + 2 >= tokens.size()) {
-                std::cerr << "INNER JOIN syntax error: Missing join table.\n";
+            c.next();
+            std::string joinTable, left, right;
+            if (!expectName(c, joinTable, "a join table")) return nullptr;
+            if (!c.accept(Keyword::ON)) {
+                std::cerr << "INNER JOIN syntax error: Missing ON clause.\n";
                 return nullptr;
             }
-            std::string joinTable = stripComma(tokens[innerIndex + 2]);
-
-            // Find ON
-            size_t onIndex = findToken(upperTokens, "ON", innerIndex + 3);
-            if (onIndex == std::string::npos || onIndex + 1 >= tokens.size()) {
-                std::cerr << "INNER JOIN syntax error: Missing ON clause.\n";
+            if (!expectName(c, left, "a join column") || !expect(c, '=') || !expectName(c, right, "a join column")) {
                 return nullptr;
             }
+            joins.push_back({"INNER JOIN", joinTable, left + " = " + right});
+        }
 
-            // Extract join condition until we hit another INNER/WHERE/END
-            size_t conditionStart = onIndex + 1;
-            size_t conditionEnd = tokens.size();
-
-            // We will stop if we reach another INNER or WHERE
-            size_t nextInner = findToken(upperTokens, "INNER", conditionStart);
-            size_t whereIndex = findToken(upperTokens, "WHERE", conditionStart);
+        WhereClause where;
+        if (c.accept(Keyword::WHERE) && !(where.root = parseOr(c))) return nullptr;
 
-            if (whereIndex != std::string::npos && whereIndex < conditionEnd) {
-                conditionEnd = whereIndex;
+        // GROUP BY col1, col2, ...
+        std::vector<std::string> groupBy;
+        if (c.accept(Keyword::GROUP)) {
+            if (!c.accept(Keyword::BY) || c.peek().kind != TokenKind::WORD) {
+                std::cerr << "GROUP BY clause requires at least one column.\n";
+                return nullptr;
             }
-            if (nextInner != std::string::npos && nextInner < conditionEnd) {
-                conditionEnd = nextInner;
+            do {
+                std::string col;
+                if (!expectName(c, col, "a column")) return nullptr;
+                groupBy.push_back(col);
+            } while (c.accept(','));
+        }
+
+        // ORDER BY col [ASC|DESC], ...
+        std::vector<SelectCommand::OrderKey> orderBy;
+        if (c.accept(Keyword::ORDER)) {
+            if (!c.accept(Keyword::BY) || c.peek().kind != TokenKind::WORD) {
+                std::cerr << "ORDER BY clause requires at least one column.\n";
+                return nullptr;
             }
-
-            std::ostringstream oss;
-            for (size_t i = conditionStart; i < conditionEnd; ++i) {
-                oss << tokens[i] << " ";
+            do {
+                std::string col;
+                if (!expectName(c, col, "a column")) return nullptr;
+                // Aggregates are referred to by their select list text, e.g. COUNT(*)
+                if (c.accept('(')) {
+                    std::string arg;
+                    if (!expectName(c, arg, "a column") || !expect(c, ')')) return nullptr;
+                    col = toUpper(col) + "(" + arg + ")";
+                }
+                bool descending = false;
+                if (c.accept(Keyword::DESC)) descending = true;
+                else c.accept(Keyword::ASC);
+                orderBy.push_back({col, descending});
+            } while (c.accept(','));
+        }
+
+        // LIMIT n [OFFSET m]
+        int64_t limit = -1;
+        size_t offset = 0;
+        if (c.accept(Keyword::LIMIT)) {
+            if (!parseCount(c, limit)) {
+                std::cerr << "LIMIT requires a non-negative integer.\n";
+                return nullptr;
             }
-            std::string joinCondition = trim(oss.str());
-            joinCondition = stripSemicolon(joinCondition);
-
-            SelectCommand::JoinClause jc{"INNER JOIN", joinTable, joinCondition};
-            joins.push_back(jc);
-
-            // Move currentIndex to conditionEnd, continue searching for next join or WHERE
-            currentIndex = conditionEnd;
-        }
-
-        // Check if WHERE present
-        size_t whereIdx = findToken(upperTokens, "WHERE", currentIndex);
-        if (whereIdx != std::string::npos && whereIdx + 1 < tokens.size()) {
-            std::ostringstream oss;
-            for (size_t i = whereIdx + 1; i < tokens.size(); ++i) {
-                oss << tokens[i] << " ";
+            if (c.accept(Keyword::OFFSET)) {
+                int64_t parsedOffset = 0;
+                if (!parseCount(c, parsedOffset)) {
+                    std::cerr << "OFFSET requires a non-negative integer.\n";
+                    return nullptr;
+                }
+                offset = (size_t)parsedOffset;
             }
-            whereClause = trim(oss.str());
-            whereClause = stripSemicolon(whereClause);
         }
 
-        return std::make_unique<SelectCommand>(columns, tableName, whereClause, joins);
+        if (!finish(c)) return nullptr;
+        return std::make_unique<SelectCommand>(columns, tableName, std::move(where), joins, groupBy, aggregates,
+                                               orderBy, limit, offset);
     }
 
-    static std::unique_ptr<Command> parseUpdate(const std::vector<std::string>& tokens, const std::vector<std::string>& upperTokens) {
+    static std::unique_ptr<Command> parseUpdate(Cursor& c) {
         // UPDATE table_name SET col1 = val1, col2 = val2 WHERE condition;
-        if (tokens.size() < 4) {
-            std::cerr << "UPDATE command requires at least table name and SET clause.\n";
-            return nullptr;
-        }
-
-        std::string tableName = tokens[1];
-        std::vector<std::pair<std::string, std::string>> updates;
-
-        // Find SET index
-        size_t setIndex = findToken(upperTokens, "SET");
-        if (setIndex == std::string::npos || setIndex + 1 >= tokens.size()) {
+        c.pos++;
+        std::string tableName;
+        if (!expectName(c, tableName, "a table name")) return nullptr;
+        if (!c.accept(Keyword::SET)) {
             std::cerr << "UPDATE command missing SET clause.\n";
             return nullptr;
         }
 
-        // Find WHERE index
-        size_t whereIndex = findToken(upperTokens, "WHERE", setIndex + 1);
-
-        // Parse set clauses between SET and WHERE (or end)
-        size_t endSet = (whereIndex != std::string::npos) ? whereIndex : tokens.size();
-        for (size_t i = setIndex + 1; i < endSet; ) {
-            std::string colName = stripComma(tokens[i]);
-            if (i + 1 >= tokens.size() || tokens[i + 1] != "=") {
+        std::vector<std::pair<std::string, std::string>> updates;
+        do {
+            std::string colName, val;
+            if (!expectName(c, colName, "a column name")) return nullptr;
+            if (!c.accept('=')) {
                 std::cerr << "Malformed SET clause in UPDATE command.\n";
                 return nullptr;
             }
-            if (i + 2 >= tokens.size()) {
+            if (c.peek().kind == TokenKind::END || c.peek().kind == TokenKind::SYMBOL) {
                 std::cerr << "Missing value in SET clause of UPDATE command.\n";
                 return nullptr;
             }
-            std::string val = tokens[i + 2];
-            // Remove surrounding quotes if present
-            if (isQuoted(val)) {
-                val = unquote(val);
-            }
+            expectValue(c, val, false);
             updates.emplace_back(colName, val);
-            i += 3; // Move past "col = val"
-            if (i < endSet && tokens[i] == ",") {
-                ++i; // Skip comma
-            }
-        }
+        } while (c.accept(','));
 
-        // Parse WHERE clause if present
-        std::string whereClause;
-        if (whereIndex != std::string::npos && whereIndex + 1 < tokens.size()) {
-            std::ostringstream oss;
-            for (size_t i = whereIndex + 1; i < tokens.size(); ++i) {
-                oss << tokens[i] << " ";
-            }
-            whereClause = trim(oss.str());
-            whereClause = stripSemicolon(whereClause);
-        }
+        WhereClause where;
+        if (c.accept(Keyword::WHERE) && !(where.root = parseOr(c))) return nullptr;
 
-        return std::make_unique<UpdateCommand>(tableName, updates, whereClause);
+        if (!finish(c)) return nullptr;
+        return std::make_unique<UpdateCommand>(tableName, updates, std::move(where));
     }
 
-    static std::unique_ptr<Command> parseDelete(const std::vector<std::string>& tokens, const std::vector<std::string>& upperTokens) {
+    static std::unique_ptr<Command> parseDelete(Cursor& c) {
         // DELETE FROM table_name WHERE condition;
-        if (tokens.size() < 3) {
+        c.pos++;
+        std::string tableName;
+        if (!expect(c, Keyword::FROM, "FROM")) return nullptr;
+        if (c.peek().kind != TokenKind::WORD) {
             std::cerr << "DELETE FROM command requires a table name.\n";
             return nullptr;
         }
+        expectName(c, tableName, "a table name");
 
-        std::string tableName = stripSemicolon(tokens[2]);
-        std::string whereClause;
+        WhereClause where;
+        if (c.accept(Keyword::WHERE) && !(where.root = parseOr(c))) return nullptr;
 
-        // Check for WHERE
-        size_t whereIndex = findToken(upperTokens, "WHERE");
-        if (whereIndex != std::string::npos && whereIndex + 1 < tokens.size()) {
-            std::ostringstream oss;
-            for (size_t i = whereIndex + 1; i < tokens.size(); ++i) {
-                oss << tokens[i] << " ";
-            }
-            whereClause = trim(oss.str());
-            whereClause = stripSemicolon(whereClause);
-        }
-
-        return std::make_unique<DeleteCommand>(tableName, whereClause);
+        if (!finish(c)) return nullptr;
+        return std::make_unique<DeleteCommand>(tableName, std::move(where));
     }
 
     // -------------------
-    // Helper functions
+    // WHERE expressions
     // -------------------
-    // Tokenize the input string, preserving quoted strings as single tokens
-    static std::vector<std::string> tokenize(const std::string& str) {
-        std::vector<std::string> tokens;
-        std::string token;
-        bool inQuotes = false;
-        char quoteChar = '\0';
-
-        for (size_t i = 0; i < str.size(); ++i) {
-            char c = str[i];
-
-            if (inQuotes) {
-                if (c == quoteChar) {
-                    inQuotes = false;
-                    token += c;
-                    tokens.push_back(token);
-                    token.clear();
-                } else {
-                    token += c;
-                }
-            } else {
-                if (c == '"' || c == '\'') {
-                    inQuotes = true;
-                    quoteChar = c;
-                    if (!token.empty()) {
-                        tokens.push_back(token);
-                        token.clear();
-                    }
-                    token += c;
-                }
-                else if (std::isspace(static_cast<unsigned char>(c))) {
-                    if (!token.empty()) {
-                        tokens.push_back(token);
-                        token.clear();
-                    }
-                }
-                else if (c == '(' || c == ')' || c == ',' || c == ';') {
-                    if (!token.empty()) {
-                        tokens.push_back(token);
-                        token.clear();
-                    }
-                    std::string punct(1, c);
-                    tokens.push_back(punct);
-                }
-                else {
-                    token += c;
-                }
-            }
-        }
+    // or_expr := and_expr { OR and_expr }
+    static std::unique_ptr<ExpressionNode> parseOr(Cursor& c) {
+        auto left = parseAnd(c);
+        while (left && c.accept(Keyword::OR)) {
+            auto right = parseAnd(c);
+            if (!right) return nullptr;
+            left = combine("OR", std::move(left), std::move(right));
+        }
+        return left;
+    }
 
-        if (!token.empty()) {
-            tokens.push_back(token);
+    // and_expr := primary { AND primary }
+    static std::unique_ptr<ExpressionNode> parseAnd(Cursor& c) {
+        auto left = parsePrimary(c);
+        while (left && c.accept(Keyword::AND)) {
+            auto right = parsePrimary(c);
+            if (!right) return nullptr;
+            left = combine("AND", std::move(left), std::move(right));
         }
-
-        return tokens;
+        return left;
     }
 
-    // Split input string into statements based on semicolon, ignoring semicolons within quotes
-    static std::vector<std::string> splitBySemicolon(const std::string& content) {
-        std::vector<std::string> statements;
-        std::string current;
-        bool inQuotes = false;
-        char quoteChar = '\0';
-
-        for (size_t i = 0; i < content.size(); ++i) {
-            char c = content[i];
-
-            if (inQuotes) {
-                if (c == quoteChar) {
-                    inQuotes = false;
-                }
-                current += c;
-            }
-            else {
-                if (c == '"' || c == '\'') {
-                    inQuotes = true;
-                    quoteChar = c;
-                    current += c;
-                }
-                else if (c == ';') {
-                    if (!current.empty()) {
-                        statements.push_back(trim(current));
-                        current.clear();
-                    }
-                }
-                else {
-                    current += c;
-                }
-            }
+    // primary := '(' or_expr ')' | column op value
+    static std::unique_ptr<ExpressionNode> parsePrimary(Cursor& c) {
+        if (c.accept('(')) {
+            auto inner = parseOr(c);
+            if (!inner || !expect(c, ')')) return nullptr;
+            return inner;
         }
 
-        // Add any remaining statement
-        std::string leftover = trim(current);
-        if (!leftover.empty()) {
-            statements.push_back(leftover);
+        auto node = std::make_unique<ExpressionNode>();
+        node->isLeaf = true;
+        Condition& cond = node->leafCondition;
+        if (!expectName(c, cond.columnName, "a column")) return nullptr;
+
+        const Token& op = c.peek();
+        if (op.kind != TokenKind::SYMBOL || op.is('(') || op.is(')') || op.is(',') || op.is(';') || op.text == "!") {
+            syntaxError(op, "a comparison operator");
+            return nullptr;
         }
+        c.next();
+        cond.op = op.text == "!=" ? "<>" : std::string(op.text);
 
-        return statements;
+        // Quotes are kept: the literal is typed against its column when the clause is bound
+        if (!expectValue(c, cond.value, true)) return nullptr;
+        return node;
     }
 
-    // Convert string to uppercase
-    static std::string toUpper(const std::string& s) {
-        std::string out = s;
-        std::transform(out.begin(), out.end(), out.begin(), ::toupper);
-        return out;
+    static std::unique_ptr<ExpressionNode> combine(const char* op, std::unique_ptr<ExpressionNode> left,
+                                                   std::unique_ptr<ExpressionNode> right) {
+        auto parent = std::make_unique<ExpressionNode>();
+        parent->isLeaf = false;
+        parent->op = op;
+        parent->left = std::move(left);
+        parent->right = std::move(right);
+        return parent;
     }
 
-    // Find the first occurrence of a token starting from a given index
-    static size_t findToken(const std::vector<std::string>& tokens, const std::string& target, size_t start = 0) {
-        for (size_t i = start; i < tokens.size(); ++i) {
-            if (toUpper(tokens[i]) == target) {
-                return i;
-            }
-        }
-        return std::string::npos;
+    // -------------------
+    // Helper functions
+    // -------------------
+    // Non-negative integer literal (LIMIT / OFFSET)
+    static bool parseCount(Cursor& c, int64_t& out) {
+        const Token& token = c.peek();
+        if (token.kind != TokenKind::NUMBER
+            || !std::all_of(token.text.begin(), token.text.end(), [](unsigned char ch) { return std::isdigit(ch); })) {
+            return false;
+        }
+        c.next();
+        return parseInt(token.text, out);
     }
 
-    // Strip trailing semicolon from a token
-    static std::string stripSemicolon(const std::string& s) {
-        if (!s.empty() && s.back() == ';') {
-            return s.substr(0, s.size() - 1);
-        }
-        return s;
+    static bool isAggregateFunction(const std::string& upperName) {
+        return upperName == "COUNT" || upperName == "SUM" || upperName == "AVG" || upperName == "MIN" || upperName == "MAX";
     }
 
-    // Strip trailing comma from a token
-    static std::string stripComma(const std::string& s) {
-        if (!s.empty() && s.back() == ',') {
-            return s.substr(0, s.size() - 1);
-        }
-        return s;
+    // Convert string to uppercase
+    static std::string toUpper(const std::string& s) {
+        std::string out = s;
+        std::transform(out.begin(), out.end(), out.begin(), ::toupper);
+        return out;
     }
 
     // Trim leading and trailing whitespace
@@ -548,19 +584,6 @@ private:
         while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) end--;
         return s.substr(start, end - start);
     }
-
-    // Check if a string is quoted
-    static bool isQuoted(const std::string& s) {
-        return (s.size() >= 2) && ((s.front() == '"' && s.back() == '"') || (s.front() == '\'' && s.back() == '\''));
-    }
-
-    // Remove surrounding quotes from a string
-    static std::string unquote(const std::string& s) {
-        if (isQuoted(s)) {
-            return s.substr(1, s.size() - 2);
-        }
-        return s;
-    }
 };
 
 #endif // PARSER_H
@@ -0,0 +1,93 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <cfloat>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "Value.h"
+
+// Formats query results into a reusable buffer and hands it to the stream in large
+// blocks. Numbers are written with std::to_chars, so formatting a cell neither
+// allocates nor goes through a stringstream. Output matches Value::getDisplayValue.
+class ResultWriter {
+public:
+    explicit ResultWriter(std::ostream& out) : out(out), buffer(BLOCK_SIZE) {}
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    ~ResultWriter() { flush(); }
+
+    void write(char c) {
+        if (used == BLOCK_SIZE) flush();
+        buffer[used++] = c;
+    }
+
+    void write(std::string_view text) {
+        if (text.size() > BLOCK_SIZE - used) {
+            flush();
+            if (text.size() > BLOCK_SIZE) {
+                out.write(text.data(), (std::streamsize)text.size());
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, text.data(), text.size());
+        used += text.size();
+    }
+
+    void writeInt(int64_t v) {
+        if (BLOCK_SIZE - used < MAX_NUMBER) flush();
+        char* first = buffer.data() + used;
+        used = std::to_chars(first, first + MAX_NUMBER, v).ptr - buffer.data();
+    }
+
+    // Fixed notation with two decimals, like std::fixed << std::setprecision(2)
+    void writeFloat(double v) {
+        if (BLOCK_SIZE - used < MAX_NUMBER) flush();
+        char* first = buffer.data() + used;
+        auto [end, ec] = std::to_chars(first, first + MAX_NUMBER, v, std::chars_format::fixed, 2);
+        if (ec == std::errc()) {
+            used = end - buffer.data();
+            return;
+        }
+        // Longer than MAX_NUMBER in fixed notation (|v| above ~1e60)
+        char big[DBL_MAX_10_EXP + 8];
+        write(std::string_view(big, std::to_chars(big, big + sizeof(big), v, std::chars_format::fixed, 2).ptr - big));
+    }
+
+    // TEXT cells are shown in single quotes
+    void writeText(std::string_view text) {
+        write('\'');
+        write(text);
+        write('\'');
+    }
+
+    void writeValue(const Value& v) {
+        switch (v.getType()) {
+            case DataType::INT: writeInt(v.getInt()); break;
+            case DataType::FLOAT: writeFloat(v.getFloat()); break;
+            case DataType::TEXT: writeText(v.getText()); break;
+        }
+    }
+
+    // Hand everything buffered to the stream
+    void flush() {
+        if (used == 0) return;
+        out.write(buffer.data(), (std::streamsize)used);
+        used = 0;
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+    static constexpr size_t MAX_NUMBER = 64; // room kept free before formatting a number
+
+    std::ostream& out;
+    std::vector<char> buffer;
+    size_t used = 0;
+};
+
+#endif //RESULTWRITER_H
@@ -7,51 +7,43 @@
 
 
 #include <vector>
+#include <iostream>
 #include "Utils.h"
 #include "Value.h"
 
 class Row {
 public:
-    Row(const std::vector<DataType>& config, const std::vector<std::string>& rawValues): typeConfig(config) {
+    Row(const std::vector<DataType>& typeConfig, const std::vector<std::string>& rawValues) {
         if (typeConfig.size() != rawValues.size()) {
             std::cout << "Row::Row(): Wrong number of values provided" << std::endl;
             throw std::runtime_error("Row::Row(): Wrong number of values provided");
         }
 
-        for (int i = 0; i < typeConfig.size(); i++) {
-            try {values.emplace_back(typeConfig[i], rawValues[i]);}
-            catch (const std::exception& e) {
-                DataType& type = typeConfig[i];
-                switch (type) {
-                    case DataType::INT: {
-                        values.emplace_back(typeConfig[i], "114514");
-                        break;
-                    }
-                    case DataType::FLOAT: {
-                        values.emplace_back(typeConfig[i], "114.514");
-                        break;
-                    }
-                    case DataType::TEXT: {
-                        values.emplace_back(typeConfig[i], "NONE");
-                        break;
-                    }
-                }
-            }
+        // Malformed numbers fall back to placeholder values instead of failing the row
+        values.reserve(typeConfig.size());
+        for (size_t i = 0; i < typeConfig.size(); i++) {
+            values.push_back(parseRawValue(typeConfig[i], rawValues[i]));
         }
     }
 
+    // Build a row from already typed values (e.g. materialized from table columns)
+    explicit Row(std::vector<Value> typedValues): values(std::move(typedValues)) {}
+
     [[nodiscard]] bool isFormatFit(const std::vector<DataType>& config) const {
         if (config.size() != values.size()) return false;
-        for (int i = 0; i < typeConfig.size(); i++) {
-            if (typeConfig[i] != config[i]) return false;
+        for (size_t i = 0; i < values.size(); i++) {
+            if (values[i].getType() != config[i]) return false;
         }
         return true;
     }
 
     [[nodiscard]] std::vector<Value> getValues() const {return values;}
 
+    [[nodiscard]] const Value& getValue(size_t index) const {return values[index];}
+
+    [[nodiscard]] size_t size() const {return values.size();}
+
 private:
-    std::vector<DataType> typeConfig;
     std::vector<Value> values;
 };
 
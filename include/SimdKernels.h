@@ -0,0 +1,179 @@
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+#include "Utils.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MINIDB_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Comparison kernels over contiguous column data. Each kernel compares data[0..n)
+// against a constant and writes one bit per element into out (bit i of word i / 64),
+// clearing the bits past n in the last word. The AVX2 / SSE variants are chosen at
+// runtime; the scalar versions are the reference semantics (LE is !(x > c), etc.).
+namespace simd {
+
+template <typename T>
+inline bool compareScalar(T x, T c, CompareOp op) {
+    switch (op) {
+        case CompareOp::EQ: return x == c;
+        case CompareOp::NE: return !(x == c);
+        case CompareOp::LT: return x < c;
+        case CompareOp::GT: return x > c;
+        case CompareOp::LE: return !(x > c);
+        case CompareOp::GE: return !(x < c);
+    }
+    return false;
+}
+
+template <typename T>
+inline void compareTail(const T* data, size_t begin, size_t n, T c, CompareOp op, uint64_t* out) {
+    for (size_t i = begin; i < n; i++) {
+        if (compareScalar(data[i], c, op)) out[i / 64] |= uint64_t(1) << (i % 64);
+    }
+}
+
+inline void clearBits(size_t n, uint64_t* out) {
+    for (size_t w = 0; w < (n + 63) / 64; w++) out[w] = 0;
+}
+
+inline void compareInt64Scalar(const int64_t* data, size_t n, int64_t c, CompareOp op, uint64_t* out) {
+    clearBits(n, out);
+    compareTail(data, 0, n, c, op, out);
+}
+
+inline void compareDoubleScalar(const double* data, size_t n, double c, CompareOp op, uint64_t* out) {
+    clearBits(n, out);
+    compareTail(data, 0, n, c, op, out);
+}
+
+#ifdef MINIDB_X86_SIMD
+
+__attribute__((target("avx2")))
+inline void compareInt64Avx2(const int64_t* data, size_t n, int64_t c, CompareOp op, uint64_t* out) {
+    clearBits(n, out);
+    const __m256i constant = _mm256_set1_epi64x(c);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i m;
+        switch (op) {
+            case CompareOp::EQ: m = _mm256_cmpeq_epi64(x, constant); break;
+            case CompareOp::NE: m = _mm256_xor_si256(_mm256_cmpeq_epi64(x, constant), _mm256_set1_epi64x(-1)); break;
+            case CompareOp::LT: m = _mm256_cmpgt_epi64(constant, x); break;
+            case CompareOp::GT: m = _mm256_cmpgt_epi64(x, constant); break;
+            case CompareOp::LE: m = _mm256_xor_si256(_mm256_cmpgt_epi64(x, constant), _mm256_set1_epi64x(-1)); break;
+            default: m = _mm256_xor_si256(_mm256_cmpgt_epi64(constant, x), _mm256_set1_epi64x(-1)); break;
+        }
+        uint64_t bits = (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(m));
+        out[i / 64] |= bits << (i % 64);
+    }
+    compareTail(data, i, n, c, op, out);
+}
+
+__attribute__((target("avx2")))
+inline void compareDoubleAvx2(const double* data, size_t n, double c, CompareOp op, uint64_t* out) {
+    clearBits(n, out);
+    const __m256d constant = _mm256_set1_pd(c);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(data + i);
+        __m256d m;
+        switch (op) {
+            case CompareOp::EQ: m = _mm256_cmp_pd(x, constant, _CMP_EQ_OQ); break;
+            case CompareOp::NE: m = _mm256_cmp_pd(x, constant, _CMP_NEQ_UQ); break;
+            case CompareOp::LT: m = _mm256_cmp_pd(x, constant, _CMP_LT_OQ); break;
+            case CompareOp::GT: m = _mm256_cmp_pd(x, constant, _CMP_GT_OQ); break;
+            case CompareOp::LE: m = _mm256_cmp_pd(x, constant, _CMP_NGT_UQ); break;
+            default: m = _mm256_cmp_pd(x, constant, _CMP_NLT_UQ); break;
+        }
+        uint64_t bits = (uint64_t)_mm256_movemask_pd(m);
+        out[i / 64] |= bits << (i % 64);
+    }
+    compareTail(data, i, n, c, op, out);
+}
+
+__attribute__((target("sse4.2")))
+inline void compareInt64Sse(const int64_t* data, size_t n, int64_t c, CompareOp op, uint64_t* out) {
+    clearBits(n, out);
+    const __m128i constant = _mm_set1_epi64x(c);
+    const __m128i ones = _mm_set1_epi64x(-1);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i m;
+        switch (op) {
+            case CompareOp::EQ: m = _mm_cmpeq_epi64(x, constant); break;
+            case CompareOp::NE: m = _mm_xor_si128(_mm_cmpeq_epi64(x, constant), ones); break;
+            case CompareOp::LT: m = _mm_cmpgt_epi64(constant, x); break;
+            case CompareOp::GT: m = _mm_cmpgt_epi64(x, constant); break;
+            case CompareOp::LE: m = _mm_xor_si128(_mm_cmpgt_epi64(x, constant), ones); break;
+            default: m = _mm_xor_si128(_mm_cmpgt_epi64(constant, x), ones); break;
+        }
+        uint64_t bits = (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(m));
+        out[i / 64] |= bits << (i % 64);
+    }
+    compareTail(data, i, n, c, op, out);
+}
+
+// SSE2 is part of the x86-64 baseline, so this needs no runtime check there
+__attribute__((target("sse2")))
+inline void compareDoubleSse(const double* data, size_t n, double c, CompareOp op, uint64_t* out) {
+    clearBits(n, out);
+    const __m128d constant = _mm_set1_pd(c);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(data + i);
+        __m128d m;
+        switch (op) {
+            case CompareOp::EQ: m = _mm_cmpeq_pd(x, constant); break;
+            case CompareOp::NE: m = _mm_cmpneq_pd(x, constant); break;
+            case CompareOp::LT: m = _mm_cmplt_pd(x, constant); break;
+            case CompareOp::GT: m = _mm_cmpgt_pd(x, constant); break;
+            case CompareOp::LE: m = _mm_cmpngt_pd(x, constant); break;
+            default: m = _mm_cmpnlt_pd(x, constant); break;
+        }
+        uint64_t bits = (uint64_t)_mm_movemask_pd(m);
+        out[i / 64] |= bits << (i % 64);
+    }
+    compareTail(data, i, n, c, op, out);
+}
+
+#endif // MINIDB_X86_SIMD
+
+using Int64Kernel = void (*)(const int64_t*, size_t, int64_t, CompareOp, uint64_t*);
+using DoubleKernel = void (*)(const double*, size_t, double, CompareOp, uint64_t*);
+
+inline Int64Kernel selectInt64Kernel() {
+#ifdef MINIDB_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) return compareInt64Avx2;
+    if (__builtin_cpu_supports("sse4.2")) return compareInt64Sse;
+#endif
+    return compareInt64Scalar;
+}
+
+inline DoubleKernel selectDoubleKernel() {
+#ifdef MINIDB_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) return compareDoubleAvx2;
+    if (__builtin_cpu_supports("sse2")) return compareDoubleSse;
+#endif
+    return compareDoubleScalar;
+}
+
+// Kernels picked once for the running CPU
+inline void compareInt64(const int64_t* data, size_t n, int64_t c, CompareOp op, uint64_t* out) {
+    static const Int64Kernel kernel = selectInt64Kernel();
+    kernel(data, n, c, op, out);
+}
+
+inline void compareDouble(const double* data, size_t n, double c, CompareOp op, uint64_t* out) {
+    static const DoubleKernel kernel = selectDoubleKernel();
+    kernel(data, n, c, op, out);
+}
+
+} // namespace simd
+
+#endif //SIMDKERNELS_H
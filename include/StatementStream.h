@@ -0,0 +1,162 @@
+#ifndef STATEMENTSTREAM_H
+#define STATEMENTSTREAM_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Parser.h"
+
+// Splits a SQL script into statements while reading it in blocks of at most BLOCK_SIZE,
+// so memory stays bounded by the block size plus the longest statement. Semicolons inside quotes
+// do not end a statement.
+class StatementReader {
+public:
+    explicit StatementReader(std::istream& in) : in(in), buffer(BLOCK_SIZE, '\0') {}
+
+    // Read the next statement (without its ';', untrimmed); returns false at end of input
+    bool next(std::string& statement) {
+        statement.clear();
+        while (true) {
+            if (pos == filled) {
+                // Last statement may lack a terminating ';'
+                if (!refill()) return !statement.empty();
+            }
+            size_t start = pos;
+            while (pos < filled) {
+                char c = buffer[pos];
+                if (quoteChar != '\0') {
+                    if (c == quoteChar) quoteChar = '\0';
+                } else if (c == '"' || c == '\'') {
+                    quoteChar = c;
+                } else if (c == ';') {
+                    statement.append(buffer, start, pos - start);
+                    pos++;
+                    return true;
+                }
+                pos++;
+            }
+            statement.append(buffer, start, pos - start);
+        }
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    std::istream& in;
+    std::string buffer;
+    size_t pos = 0;
+    size_t filled = 0;
+    char quoteChar = '\0'; // quote of the string literal we are inside, '\0' outside
+
+    // Takes what the stream has at hand (up to a block) instead of waiting for a whole
+    // block, so a statement arriving through a pipe is returned as soon as its ';' is read
+    bool refill() {
+        std::streambuf* source = in.rdbuf();
+        pos = 0;
+        filled = 0;
+        if (source->sgetc() == std::char_traits<char>::eof()) return false; // waits for input
+        std::streamsize available = std::max<std::streamsize>(source->in_avail(), 1);
+        filled = (size_t)source->sgetn(&buffer[0], std::min<std::streamsize>(available, (std::streamsize)buffer.size()));
+        return filled > 0;
+    }
+};
+
+// Parses the statements of a script as they are read. Statements that fail to parse are
+// skipped (the parser reports them). With parseAhead, a background thread reads and parses
+// upcoming statements while the caller executes the current one; it stays at most
+// LOOKAHEAD commands ahead, so memory remains bounded.
+class CommandStream {
+public:
+    CommandStream(std::istream& in, bool parseAhead) : reader(in), parseAhead(parseAhead) {
+        if (parseAhead) producer = std::thread([this] { produce(); });
+    }
+
+    ~CommandStream() {
+        if (!parseAhead) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        changed.notify_all();
+        producer.join();
+    }
+
+    CommandStream(const CommandStream&) = delete;
+    CommandStream& operator=(const CommandStream&) = delete;
+
+    // Next successfully parsed command, or nullptr at end of input
+    std::unique_ptr<Command> next() {
+        if (!parseAhead) return parseNext();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (pending.empty()) {
+            changed.wait(lock, [this] { return !pending.empty() || finished; });
+        }
+        if (pending.empty()) {
+            if (error) std::rethrow_exception(error);
+            return nullptr;
+        }
+        auto cmd = std::move(pending.front());
+        pending.pop_front();
+        bool refill = pending.size() == LOOKAHEAD / 2;
+        lock.unlock();
+        if (refill) changed.notify_all();
+        return cmd;
+    }
+
+private:
+    StatementReader reader;
+    std::string statement;
+    bool parseAhead;
+
+    // Parsed commands waiting for the caller, who takes each one as soon as it is parsed.
+    // A parser that filled the queue only resumes once it is half empty, so the caller
+    // does not wake it for every statement.
+    static constexpr size_t LOOKAHEAD = 16;
+    std::thread producer;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::unique_ptr<Command>> pending;
+    bool finished = false;  // producer reached the end of input (or failed)
+    bool stopped = false;   // the caller is gone
+    std::exception_ptr error;
+
+    std::unique_ptr<Command> parseNext() {
+        while (reader.next(statement)) {
+            if (auto cmd = Parser::parse(statement)) return cmd;
+        }
+        return nullptr;
+    }
+
+    void produce() {
+        try {
+            while (auto cmd = parseNext()) {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (pending.size() == LOOKAHEAD) {
+                    changed.wait(lock, [this] { return pending.size() <= LOOKAHEAD / 2 || stopped; });
+                }
+                if (stopped) return;
+                bool wasEmpty = pending.empty(); // the caller may be waiting
+                pending.push_back(std::move(cmd));
+                lock.unlock();
+                if (wasEmpty) changed.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        changed.notify_all();
+    }
+};
+
+#endif //STATEMENTSTREAM_H
@@ -8,8 +8,14 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
 #include "Row.h"
 #include "Column.h"
+#include "HashIndex.h"
+#include "BTreeIndex.h"
+#include "ZoneMap.h"
 
 class Table {
 public:
@@ -25,16 +31,17 @@ public:
 
     [[nodiscard]] bool addRow(const Row& row) {
         if (!row.isFormatFit(typeConfig)) return false;
-        rows.push_back(row);
 
-        // add to each column
-        std::vector<Value> rowValues = row.getValues();
+        // append each value to its column
         for (size_t columnIdx = 0; columnIdx < columns.size(); columnIdx++) {
-            if (!columns[columnIdx].addValue(std::make_shared<Value>(rowValues[columnIdx]))) {
+            if (!columns[columnIdx].addValue(row.getValue(columnIdx))) {
                 std::cerr << "Failed to add value to column " << columns[columnIdx].getTitle() << "\n";
                 return false;
             }
         }
+        rowsAdded(numRows, numRows + 1);
+        numRows++;
+        modifications++;
 
         return true;
     }
@@ -44,60 +51,313 @@ public:
         return addRow(newRow);
     }
 
-    bool deleteRow(size_t index) {
-        if (index >= rows.size()) {
-            std::cerr << "Invalid row index.\n";
-            return false;
+    // Append a batch of raw rows column by column, without materializing Row objects.
+    // The batch is rejected as a whole if any row has the wrong number of values.
+    [[nodiscard]] bool addRows(const std::vector<std::vector<std::string>>& rawRows) {
+        for (const auto& rawValues : rawRows) {
+            if (rawValues.size() != columns.size()) {
+                std::cerr << "Wrong number of values for table " << name << ": expected " << columns.size()
+                          << ", got " << rawValues.size() << "\n";
+                return false;
+            }
+        }
+
+        for (size_t columnIdx = 0; columnIdx < columns.size(); columnIdx++) {
+            Column& column = columns[columnIdx];
+            column.reserveAdditional(rawRows.size());
+            for (const auto& rawValues : rawRows) column.appendRaw(rawValues[columnIdx]);
         }
+        rowsAdded(numRows, numRows + rawRows.size());
+        numRows += rawRows.size();
+        modifications++;
+
+        return true;
+    }
 
-        // Remove the row
-        rows.erase(rows.begin() + index);
-        // Also remove values from columns
-        for (auto &col : columns) {
-            if (!col.removeValueAt(index)) {
-                std::cerr << "Failed to remove column value at index " << index << "\n";
+    // Append column buffers built elsewhere (e.g. by a bulk import), one per table column
+    // with matching types and equal lengths; the buffers are left empty
+    [[nodiscard]] bool appendColumns(std::vector<Column>& parts) {
+        if (parts.size() != columns.size()) return false;
+        size_t added = parts.empty() ? 0 : parts[0].size();
+        for (size_t columnIdx = 0; columnIdx < columns.size(); columnIdx++) {
+            if (parts[columnIdx].getType() != columns[columnIdx].getType() || parts[columnIdx].size() != added) {
+                std::cerr << "Column buffers do not match table " << name << "\n";
                 return false;
             }
         }
 
+        for (size_t columnIdx = 0; columnIdx < columns.size(); columnIdx++) {
+            columns[columnIdx].append(std::move(parts[columnIdx]));
+        }
+        rowsAdded(numRows, numRows + added);
+        numRows += added;
+        modifications++;
+
         return true;
     }
 
-    // A helper method to update a specific row (and columns) given a set of new raw values.
-    bool updateRowValues(size_t index, const std::vector<std::string>& newRawValues) {
-        if (index >= rows.size()) {
+    // Deleting only marks the row in the tombstone bitmap: its id stays valid, scans skip it
+    // and it remains in the indexes until compact() drops it with every other deleted row
+    bool deleteRow(size_t index) {
+        if (index >= numRows || isDeleted(index)) {
+            std::cerr << "Invalid row index.\n";
+            return false;
+        }
+        if (tombstones.size() <= index / 64) tombstones.resize(numRows / 64 + 1, 0);
+        tombstones[index / 64] |= uint64_t(1) << (index % 64);
+        deadRows++;
+        modifications++;
+
+        return true;
+    }
+
+    [[nodiscard]] bool isDeleted(size_t index) const {
+        return index / 64 < tombstones.size() && (tombstones[index / 64] >> (index % 64) & 1);
+    }
+
+    // Clears the bits of deleted rows in a scan bitmap of rows [begin, begin + count)
+    void maskDeleted(size_t begin, size_t count, uint64_t* bitmap) const {
+        if (deadRows == 0) return;
+        for (size_t w = 0; w < (count + 63) / 64; w++) {
+            size_t row = begin + w * 64;
+            size_t word = row / 64, shift = row % 64;
+            uint64_t dead = word < tombstones.size() ? tombstones[word] >> shift : 0;
+            if (shift != 0 && word + 1 < tombstones.size()) dead |= tombstones[word + 1] << (64 - shift);
+            bitmap[w] &= ~dead;
+        }
+    }
+
+    // Worth compacting once deleted rows make up a COMPACT_FRACTION of the table
+    [[nodiscard]] bool needsCompaction() const {
+        return deadRows > 0 && deadRows * COMPACT_FRACTION >= numRows;
+    }
+
+    // Drops the deleted rows in one linear pass over each column; the remaining rows keep
+    // their order and are renumbered consecutively, in the indexes as well
+    void compact() {
+        if (deadRows == 0) return;
+        std::vector<size_t> newIds(numRows);
+        size_t kept = 0;
+        for (size_t rowIdx = 0; rowIdx < numRows; rowIdx++) newIds[rowIdx] = isDeleted(rowIdx) ? SIZE_MAX : kept++;
+
+        for (auto& col : columns) col.compact(newIds, kept);
+        for (size_t c = 0; c < columns.size(); c++) zoneMaps[c].build(columns[c]);
+        for (auto& idx : indexes) idx.remapRows(newIds);
+        for (auto& idx : orderedIndexes) idx.remapRows(newIds);
+        numRows = kept;
+        deadRows = 0;
+        tombstones.clear();
+        modifications++;
+    }
+
+    // Drops the rows from `count` on, e.g. to undo an append that could not be made durable.
+    // The remaining rows keep their ids.
+    void truncate(size_t count) {
+        if (count >= numRows) return;
+        std::vector<size_t> newIds(numRows, SIZE_MAX);
+        for (size_t rowIdx = 0; rowIdx < count; rowIdx++) newIds[rowIdx] = rowIdx;
+        for (size_t rowIdx = count; rowIdx < numRows; rowIdx++) deadRows -= isDeleted(rowIdx);
+
+        for (auto& col : columns) col.compact(newIds, count);
+        for (size_t c = 0; c < columns.size(); c++) zoneMaps[c].build(columns[c]);
+        for (auto& idx : indexes) idx.remapRows(newIds);
+        for (auto& idx : orderedIndexes) idx.remapRows(newIds);
+        numRows = count;
+        if (tombstones.size() > (count + 63) / 64) tombstones.resize((count + 63) / 64);
+        if (count % 64 && !tombstones.empty() && tombstones.size() == (count + 63) / 64) {
+            tombstones.back() &= (uint64_t(1) << (count % 64)) - 1;
+        }
+        modifications++;
+    }
+
+    // Overwrites the given cells of one row in place, (column index, value) pairs applied in
+    // order. Only indexes on those columns are touched, so the cost does not depend on the
+    // width of the table.
+    bool updateCells(size_t index, const std::vector<std::pair<size_t, Value>>& assignments) {
+        if (index >= numRows || isDeleted(index)) {
             std::cerr << "Invalid row index.\n";
             return false;
         }
+        for (const auto& [c, value] : assignments) {
+            if (c >= columns.size() || value.getType() != typeConfig[c]) {
+                std::cerr << "Row format does not fit table configuration.\n";
+                return false;
+            }
+        }
+
+        for (const auto& [c, value] : assignments) {
+            auto reindex = [this, index, c = c, &value](auto& idx) {
+                if (idx.getColumnIdx() != c) return;
+                idx.erase(columns[c].getValue(index), index);
+                idx.insert(value, index);
+            };
+            for (auto& idx : indexes) reindex(idx);
+            for (auto& idx : orderedIndexes) reindex(idx);
+            columns[c].updateValueAt(index, value);
+            zoneMaps[c].widen(index, value);
+        }
+        modifications++;
+
+        return true;
+    }
 
-        Row newRow(typeConfig, newRawValues);
-        if (!newRow.isFormatFit(typeConfig)) {
+    // Replaces a whole row given its raw values
+    bool updateRowValues(size_t index, const std::vector<std::string>& newRawValues) {
+        if (newRawValues.size() != columns.size()) {
             std::cerr << "Row format does not fit table configuration.\n";
             return false;
         }
+        std::vector<std::pair<size_t, Value>> assignments;
+        assignments.reserve(columns.size());
+        for (size_t c = 0; c < columns.size(); c++) {
+            assignments.emplace_back(c, parseRawValue(typeConfig[c], newRawValues[c]));
+        }
+        return updateCells(index, assignments);
+    }
+
+    // Row ids run from 0 to rowCount(); deleted rows keep theirs until the next compact()
+    [[nodiscard]] size_t rowCount() const { return numRows; }
+    [[nodiscard]] size_t deletedRowCount() const { return deadRows; }
 
-        rows[index] = newRow; // Update the row
-        // Update columns
-        std::vector<Value> vals = newRow.getValues();
+    // Increases with every change to the rows or index definitions; compared against the
+    // value at the last save to tell whether the table has to be written again
+    [[nodiscard]] uint64_t getModificationCount() const { return modifications; }
+
+    // Bulk-load the storage of an empty table (e.g. from a data file). The loaded columns
+    // must match the schema and all hold rowCount values; indexes are created afterwards.
+    // Zone maps stored alongside the columns are taken over if they cover the rows in
+    // blocks of the current size, otherwise they are rebuilt from the columns.
+    bool loadColumns(std::vector<Column> loaded, size_t rowCount, std::vector<ZoneMap> loadedZones = {}) {
+        if (numRows != 0 || !indexes.empty() || !orderedIndexes.empty() || loaded.size() != columns.size()) return false;
         for (size_t c = 0; c < columns.size(); c++) {
-            if (!columns[c].updateValueAt(index, std::make_shared<Value>(vals[c]))) {
-                std::cerr << "Failed to update column " << columns[c].getTitle() << " at index " << index << "\n";
+            if (loaded[c].getTitle() != columns[c].getTitle() || loaded[c].getType() != columns[c].getType()
+                || loaded[c].size() != rowCount) {
                 return false;
             }
         }
+        columns = std::move(loaded);
+        numRows = rowCount;
 
+        size_t blocks = (rowCount + ZoneMap::BLOCK_SIZE - 1) / ZoneMap::BLOCK_SIZE;
+        bool zonesFit = loadedZones.size() == columns.size();
+        for (size_t c = 0; zonesFit && c < columns.size(); c++) {
+            zonesFit = loadedZones[c].getType() == columns[c].getType() && loadedZones[c].blockCount() == blocks;
+        }
+        if (zonesFit) {
+            zoneMaps = std::move(loadedZones);
+        } else {
+            for (size_t c = 0; c < columns.size(); c++) zoneMaps[c].build(columns[c]);
+        }
+        modifications++;
         return true;
     }
 
-    std::vector<Row> findRow() {
-        // Just return all rows as a placeholder.
-        // Future improvement: add parameters and filter by conditions here.
-        return rows;
+    // Materialize a single row from the column storage
+    [[nodiscard]] Row getRow(size_t index) const {
+        std::vector<Value> values;
+        values.reserve(columns.size());
+        for (const auto& col : columns) {
+            values.push_back(col.getValue(index));
+        }
+        return Row(std::move(values));
+    }
+
+    [[nodiscard]] Value getValue(size_t rowIdx, size_t colIdx) const {
+        return columns[colIdx].getValue(rowIdx);
+    }
+
+    // Returns the index of the column with the given title, or -1 if not found
+    [[nodiscard]] int findColumnIndex(const std::string& title) const {
+        for (int i = 0; i < (int)columns.size(); i++) {
+            if (columns[i].getTitle() == title) return i;
+        }
+        return -1;
     }
 
     [[nodiscard]] const std::vector<Column>& getColumns() const { return columns; }
 
-    [[nodiscard]] const std::vector<Row>& getRows() const { return rows; }
+    // Per-block value ranges of each column, kept up to date by every change to the rows
+    [[nodiscard]] const ZoneMap& getZoneMap(size_t colIdx) const { return zoneMaps[colIdx]; }
+    [[nodiscard]] const std::vector<ZoneMap>& getZoneMaps() const { return zoneMaps; }
+
+    // Estimated number of distinct values among the live rows of a column, for join planning.
+    // Counted over an evenly spaced sample of at most STATS_SAMPLE_ROWS rows and scaled up
+    // by the GEE estimator: each value seen once in the sample stands for sqrt(rows / sample)
+    // distinct values, each value seen more often for itself. Cached until the table changes.
+    [[nodiscard]] size_t distinctEstimate(size_t colIdx) {
+        if (distinctStats.size() != columns.size()) distinctStats.assign(columns.size(), {UINT64_MAX, 0});
+        auto& [computedAt, estimate] = distinctStats[colIdx];
+        if (computedAt != modifications) {
+            const Column& column = columns[colIdx];
+            switch (column.getType()) {
+                case DataType::INT: estimate = sampleDistinct(column.getInts()); break;
+                case DataType::FLOAT: estimate = sampleDistinct(column.getFloats()); break;
+                case DataType::TEXT: estimate = sampleDistinct(column.getTexts()); break;
+            }
+            computedAt = modifications;
+        }
+        return estimate;
+    }
+
+    // Build an index over an existing column; it is kept in sync by addRow/updateCells/compact
+    bool createIndex(const std::string& indexName, const std::string& columnName, IndexKind kind = IndexKind::HASH) {
+        int colIdx = findColumnIndex(columnName);
+        if (colIdx == -1) {
+            std::cerr << "Column " << columnName << " not found in table " << name << "\n";
+            return false;
+        }
+        if (hasIndex(indexName)) {
+            std::cerr << "Index " << indexName << " already exists\n";
+            return false;
+        }
+        if (kind == IndexKind::BTREE) {
+            orderedIndexes.emplace_back(indexName, columnName, (size_t)colIdx, columns[colIdx].getType());
+            orderedIndexes.back().build(columns[colIdx]);
+        } else {
+            indexes.emplace_back(indexName, columnName, (size_t)colIdx, columns[colIdx].getType());
+            indexes.back().build(columns[colIdx]);
+        }
+        modifications++;
+        return true;
+    }
+
+    // True if a hash or B+tree index has the given name
+    [[nodiscard]] bool hasIndex(const std::string& indexName) const {
+        return getIndex(indexName) || getOrderedIndex(indexName);
+    }
+
+    [[nodiscard]] const HashIndex* getIndex(const std::string& indexName) const {
+        for (const auto& index : indexes) {
+            if (index.getName() == indexName) return &index;
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] const BTreeIndex* getOrderedIndex(const std::string& indexName) const {
+        for (const auto& index : orderedIndexes) {
+            if (index.getName() == indexName) return &index;
+        }
+        return nullptr;
+    }
+
+    // Returns a hash index on the given column, or nullptr if the column is not indexed
+    [[nodiscard]] const HashIndex* getIndexOnColumn(size_t colIdx) const {
+        for (const auto& index : indexes) {
+            if (index.getColumnIdx() == colIdx) return &index;
+        }
+        return nullptr;
+    }
+
+    // Returns a B+tree index on the given column, or nullptr if there is none
+    [[nodiscard]] const BTreeIndex* getOrderedIndexOnColumn(size_t colIdx) const {
+        for (const auto& index : orderedIndexes) {
+            if (index.getColumnIdx() == colIdx) return &index;
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] const std::vector<HashIndex>& getIndexes() const { return indexes; }
+    [[nodiscard]] const std::vector<BTreeIndex>& getOrderedIndexes() const { return orderedIndexes; }
 
     // Provide access to the underlying data types if needed
     [[nodiscard]] const std::vector<DataType>& getTypeConfig() const {
@@ -105,10 +365,54 @@ public:
     }
 
 private:
+    static constexpr size_t COMPACT_FRACTION = 4;
+    static constexpr size_t STATS_SAMPLE_ROWS = 1 << 16;
+
     std::string name;
-    std::vector<Row> rows;
+    size_t numRows = 0;
+    size_t deadRows = 0;
+    std::vector<uint64_t> tombstones; // bit per row, may be shorter than the table
+    uint64_t modifications = 0;
     std::vector<Column> columns;
+    std::vector<ZoneMap> zoneMaps; // one per column
+    std::vector<HashIndex> indexes;
+    std::vector<BTreeIndex> orderedIndexes;
     std::vector<DataType> typeConfig;
+    std::vector<std::pair<uint64_t, size_t>> distinctStats; // per column: modification count, estimate
+
+    // Add the rows [begin, end), already stored in the columns, to the zone maps and every index
+    void rowsAdded(size_t begin, size_t end) {
+        for (size_t c = 0; c < columns.size(); c++) zoneMaps[c].extend(columns[c], begin, end);
+        for (auto& index : indexes) {
+            const Column& column = columns[index.getColumnIdx()];
+            for (size_t rowIdx = begin; rowIdx < end; rowIdx++) index.insert(column.getValue(rowIdx), rowIdx);
+        }
+        for (auto& index : orderedIndexes) {
+            const Column& column = columns[index.getColumnIdx()];
+            for (size_t rowIdx = begin; rowIdx < end; rowIdx++) index.insert(column.getValue(rowIdx), rowIdx);
+        }
+    }
+
+    template <typename T>
+    size_t sampleDistinct(const std::vector<T>& cells) const {
+        size_t live = numRows - deadRows;
+        if (live == 0) return 0;
+        size_t step = (numRows + STATS_SAMPLE_ROWS - 1) / STATS_SAMPLE_ROWS;
+        std::unordered_map<T, size_t> counts;
+        size_t sampled = 0;
+        for (size_t rowIdx = 0; rowIdx < numRows; rowIdx += step) {
+            if (isDeleted(rowIdx)) continue;
+            counts[cells[rowIdx]]++;
+            sampled++;
+        }
+        if (sampled == 0) return 1;
+
+        size_t once = 0;
+        for (const auto& [value, count] : counts) once += count == 1;
+        double scale = std::sqrt((double)live / (double)sampled);
+        double estimate = scale * (double)once + (double)(counts.size() - once);
+        return std::max<size_t>(1, std::min(live, (size_t)estimate));
+    }
 
     bool addColumn(const std::pair<std::string, DataType>& config) {
         for (const auto& column: columns) {
@@ -118,6 +422,7 @@ private:
             }
         }
         columns.emplace_back(config.first, config.second);
+        zoneMaps.emplace_back(config.second);
         typeConfig.push_back(config.second);
         return true;
     }
@@ -0,0 +1,162 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <algorithm>
+
+// Fixed-size work-stealing pool for data-parallel loops. parallelFor() splits the task
+// range into one contiguous run per participant (the calling thread included); each
+// participant works through its own run front to back, and once it is empty steals
+// from the back of the others' runs.
+class ThreadPool {
+public:
+    // numThreads counts the calling thread, so 1 means "run everything inline"
+    explicit ThreadPool(size_t numThreads = defaultThreadCount()) {
+        numThreads = std::max<size_t>(1, numThreads);
+        for (size_t i = 1; i < numThreads; i++) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeWorkers.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static size_t defaultThreadCount() {
+        return std::max<unsigned>(1, std::thread::hardware_concurrency());
+    }
+
+    [[nodiscard]] size_t size() const { return workers.size() + 1; }
+
+    // Runs fn(i) for every i in [0, numTasks) and blocks until all of them finished.
+    // The first exception thrown by a task is rethrown here.
+    void parallelFor(size_t numTasks, const std::function<void(size_t)>& fn) {
+        if (numTasks == 0) return;
+        if (workers.empty() || numTasks == 1) {
+            for (size_t i = 0; i < numTasks; i++) fn(i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> jobLock(jobMutex); // one loop at a time
+        auto job = std::make_shared<Job>(size(), numTasks, fn);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            currentJob = job;
+            generation++;
+        }
+        wakeWorkers.notify_all();
+
+        participate(*job, 0);
+
+        std::unique_lock<std::mutex> lock(job->doneMutex);
+        job->done.wait(lock, [&job] { return job->pending.load() == 0; });
+        {
+            std::lock_guard<std::mutex> stateLock(mutex);
+            currentJob.reset();
+        }
+        if (job->error) std::rethrow_exception(job->error);
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    struct Job {
+        Job(size_t participants, size_t numTasks, const std::function<void(size_t)>& fn)
+            : queues(participants), pending(numTasks), fn(fn) {
+            // Contiguous runs keep neighbouring tasks (e.g. morsels) on the same thread
+            size_t per = (numTasks + participants - 1) / participants;
+            for (size_t i = 0; i < numTasks; i++) queues[i / per].tasks.push_back(i);
+        }
+
+        std::vector<WorkQueue> queues;
+        std::atomic<size_t> pending;
+        const std::function<void(size_t)>& fn;
+        std::mutex doneMutex;
+        std::condition_variable done;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex jobMutex;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::shared_ptr<Job> currentJob;
+    size_t generation = 0;
+    bool stopping = false;
+
+    static bool popFront(WorkQueue& queue, size_t& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    static bool stealBack(WorkQueue& queue, size_t& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    static void participate(Job& job, size_t self) {
+        size_t n = job.queues.size();
+        size_t task;
+        while (true) {
+            bool found = popFront(job.queues[self], task);
+            for (size_t k = 1; !found && k < n; k++) {
+                found = stealBack(job.queues[(self + k) % n], task);
+            }
+            if (!found) return;
+
+            try {
+                job.fn(task);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.errorMutex);
+                if (!job.error) job.error = std::current_exception();
+            }
+            if (job.pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(job.doneMutex);
+                job.done.notify_all();
+            }
+        }
+    }
+
+    void workerLoop(size_t self) {
+        size_t seenGeneration = 0;
+        while (true) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping) return;
+                seenGeneration = generation;
+                job = currentJob;
+            }
+            if (job) participate(*job, self);
+        }
+    }
+};
+
+#endif //THREADPOOL_H
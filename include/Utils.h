@@ -6,6 +6,7 @@
 #define UTILS_H
 
 #include <string>
+#include <stdexcept>
 
 enum class DataType {
   INT,
@@ -13,6 +14,25 @@ enum class DataType {
   TEXT,
 };
 
+// Comparison operators of a WHERE leaf: =, <>, <, >, <=, >=
+enum class CompareOp { EQ, NE, LT, GT, LE, GE };
+
+// Connectives between WHERE conditions
+enum class LogicOp { AND, OR };
+
+// Secondary index structures: HASH serves equality lookups, BTREE also ranges and ordering
+enum class IndexKind { HASH, BTREE };
+
+inline std::string indexKindToString(IndexKind kind) {
+    return kind == IndexKind::BTREE ? "BTREE" : "HASH";
+}
+
+inline IndexKind stringToIndexKind(const std::string& str) {
+    if (str == "HASH") return IndexKind::HASH;
+    else if (str == "BTREE") return IndexKind::BTREE;
+    else throw std::invalid_argument("Unknown index type: " + str);
+}
+
 
 std::string dataTypeToString(DataType type) {
     switch (type) {
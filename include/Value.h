@@ -8,21 +8,61 @@
 
 
 #include <string>
+#include <cstdint>
+#include <limits>
+#include <variant>
 #include <iomanip>
 #include <sstream>
+#include <cctype>
+#include <cmath>
+#include <charconv>
+#include <string_view>
 #include "Utils.h"
 
+// Exception-free numeric parsing for the ingest path. Surrounding whitespace and a
+// leading '+' are accepted; anything else left over makes the text malformed.
+inline std::string_view trimNumber(std::string_view text) {
+    while (!text.empty() && std::isspace((unsigned char)text.front())) text.remove_prefix(1);
+    while (!text.empty() && std::isspace((unsigned char)text.back())) text.remove_suffix(1);
+    if (text.size() > 1 && text.front() == '+' && text[1] != '-') text.remove_prefix(1);
+    return text;
+}
+
+// Stored in place of malformed INT/FLOAT input
+inline constexpr int64_t INT_PLACEHOLDER = 114514;
+inline constexpr double FLOAT_PLACEHOLDER = 114.514;
+
+inline bool parseInt(std::string_view text, int64_t& out) {
+    text = trimNumber(text);
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, out);
+    return ec == std::errc() && ptr == end;
+}
+
+inline bool parseFloat(std::string_view text, double& out) {
+    text = trimNumber(text);
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, out);
+    return ec == std::errc() && ptr == end;
+}
+
 class Value {
 public:
-    Value(const DataType& type, const std::string& value): type(type) {set(value);}
+    Value(const DataType& type, const std::string& value): type(type) {
+        if (!set(value)) {
+            throw std::invalid_argument("Invalid value for " + dataTypeToString(type) + ": " + value);
+        }
+    }
+    explicit Value(int64_t intValue): type(DataType::INT), value(intValue) {}
+    explicit Value(double floatValue): type(DataType::FLOAT), value(floatValue) {}
     // ~Value() {}
 
     bool operator==(const Value& other) const {
         if (type == DataType::TEXT && other.type == DataType::TEXT) {
-            return value == other.value;
+            return getText() == other.getText();
         }
-        if ((type == DataType::INT || type == DataType::FLOAT) && (other.type == DataType::INT || other.type == DataType::FLOAT)) {
-            return compareValues(other);
+        if (isNumeric() && other.isNumeric()) {
+            return compareValues(other) == 0;
         }
         throw std::invalid_argument("Cannot compare values of incompatible types");
     }
@@ -33,20 +73,20 @@ public:
 
     bool operator<(const Value& other) const {
         if (type == DataType::TEXT && other.type == DataType::TEXT) {
-            return value < other.value;
+            return getText() < other.getText();
         }
-        if ((type == DataType::INT || type == DataType::FLOAT) && (other.type == DataType::INT || other.type == DataType::FLOAT)) {
-            return compareLessThan(other);
+        if (isNumeric() && other.isNumeric()) {
+            return compareValues(other) < 0;
         }
         throw std::invalid_argument("Cannot compare values of incompatible types");
     }
 
     bool operator>(const Value& other) const {
         if (type == DataType::TEXT && other.type == DataType::TEXT) {
-            return value > other.value;
+            return getText() > other.getText();
         }
-        if ((type == DataType::INT || type == DataType::FLOAT) && (other.type == DataType::INT || other.type == DataType::FLOAT)) {
-            return compareGreaterThan(other);
+        if (isNumeric() && other.isNumeric()) {
+            return compareValues(other) > 0;
         }
         throw std::invalid_argument("Cannot compare values of incompatible types");
     }
@@ -59,52 +99,51 @@ public:
         return !(*this < other);
     }
 
+    // Parse and validate in one pass; returns false (leaving the value unchanged) if
+    // the text is not a valid literal of this value's type
     bool set(const std::string& newValue) {
-        try {
-            // Check the current type and convert the new value accordingly
-            if (type == DataType::TEXT) {
-                // If the type is TEXT, we can directly assign the string
-                value = newValue;
-            } else if (type == DataType::INT) {
-                // If the type is INT, try to convert to an integer
-                try {
-                    value = std::to_string(std::stoll(newValue));
-                } catch (const std::invalid_argument& e) {
-                    throw std::invalid_argument("Invalid value for INT: " + newValue);
-                } catch (const std::out_of_range& e) {
-                    throw std::out_of_range("Out of range value for INT: " + newValue);
-                }
-            } else if (type == DataType::FLOAT) {
-                // If the type is FLOAT, try to convert to a float
-                try {
-                    value = std::to_string(std::stod(newValue));
-                } catch (const std::invalid_argument& e) {
-                    throw std::invalid_argument("Invalid value for FLOAT: " + newValue);
-                } catch (const std::out_of_range& e) {
-                    throw std::out_of_range("Out of range value for FLOAT: " + newValue);
-                }
-            } else {
-                throw std::invalid_argument("Unknown DataType for set operation");
+        switch (type) {
+            case DataType::TEXT: value = newValue; return true;
+            case DataType::INT: {
+                int64_t parsed;
+                if (!parseInt(newValue, parsed)) return false;
+                value = parsed;
+                return true;
+            }
+            case DataType::FLOAT: {
+                double parsed;
+                if (!parseFloat(newValue, parsed)) return false;
+                value = parsed;
+                return true;
             }
-            return true;  // Successfully updated the value
-        } catch (const std::exception& e) {
-            // Catch any exceptions and propagate them
-            throw std::invalid_argument("Error setting value: " + std::string(e.what()));
         }
+        return false;
     }
 
     [[nodiscard]] DataType getType() const {return type;}
 
+    [[nodiscard]] bool isNumeric() const {return type == DataType::INT || type == DataType::FLOAT;}
+
+    // Native accessors, only valid for the matching type
+    [[nodiscard]] int64_t getInt() const { return std::get<int64_t>(value); }
+    [[nodiscard]] double getFloat() const { return std::get<double>(value); }
+    [[nodiscard]] const std::string& getText() const { return std::get<std::string>(value); }
+
+    // Numeric value promoted to double (INT or FLOAT)
+    [[nodiscard]] double asDouble() const {
+        return type == DataType::INT ? static_cast<double>(getInt()) : getFloat();
+    }
+
     [[nodiscard]] std::string getDisplayValue() const {
         if (type == DataType::TEXT) {
-            return "'" + value + "'";
+            return "'" + getText() + "'";
         }
         else if (type == DataType::INT) {
-            return std::to_string(std::stoll(value));
+            return std::to_string(getInt());
         }
         else if (type == DataType::FLOAT) {
             std::ostringstream oss;
-            oss << std::fixed << std::setprecision(2) << std::stod(value);
+            oss << std::fixed << std::setprecision(2) << getFloat();
 
             return oss.str();
         }
@@ -113,52 +152,56 @@ public:
         }
     }
 
-    [[nodiscard]] std::string getRawValue() const { return value; }
+    // String form that parses back to exactly the same value (used for persistence)
+    [[nodiscard]] std::string getRawValue() const {
+        if (type == DataType::TEXT) {
+            return getText();
+        }
+        else if (type == DataType::INT) {
+            return std::to_string(getInt());
+        }
+        else {
+            std::ostringstream oss;
+            oss << std::setprecision(std::numeric_limits<double>::max_digits10) << getFloat();
+            return oss.str();
+        }
+    }
 
 private:
     DataType type;
-    std::string value;
-
-    // Helper function to handle value comparison
-    bool compareValues(const Value& other) const {
-        if (type == DataType::INT && other.type == DataType::INT) {
-            return std::stoi(value) == std::stoi(other.value);
-        } else if (type == DataType::FLOAT && other.type == DataType::FLOAT) {
-            return std::stof(value) == std::stof(other.value);
-        } else if (type == DataType::INT && other.type == DataType::FLOAT) {
-            return std::stof(value) == std::stof(other.value);  // Promote INT to FLOAT
-        } else if (type == DataType::FLOAT && other.type == DataType::INT) {
-            return std::stof(value) == std::stoi(other.value);  // Promote INT to FLOAT
-        }
-        throw std::invalid_argument("Unsupported DataType for comparison");
-    }
+    std::variant<int64_t, double, std::string> value;
 
-    bool compareLessThan(const Value& other) const {
+    // Helper function to handle numeric comparison, returns <0, 0 or >0
+    int compareValues(const Value& other) const {
         if (type == DataType::INT && other.type == DataType::INT) {
-            return std::stoi(value) < std::stoi(other.value);
-        } else if (type == DataType::FLOAT && other.type == DataType::FLOAT) {
-            return std::stof(value) < std::stof(other.value);
-        } else if (type == DataType::INT && other.type == DataType::FLOAT) {
-            return std::stof(value) < std::stof(other.value);  // Promote INT to FLOAT
-        } else if (type == DataType::FLOAT && other.type == DataType::INT) {
-            return std::stof(value) < std::stoi(other.value);  // Promote INT to FLOAT
-        }
-        throw std::invalid_argument("Unsupported DataType for comparison");
+            int64_t a = getInt(), b = other.getInt();
+            return (a > b) - (a < b);
+        }
+        // Promote INT to FLOAT when either side is FLOAT. NaN sorts after every other
+        // value and equals itself, as in the B+tree key order, so the order stays total.
+        double a = asDouble(), b = other.asDouble();
+        bool aNan = std::isnan(a), bNan = std::isnan(b);
+        if (aNan || bNan) return aNan - bNan;
+        return (a > b) - (a < b);
     }
+};
 
-    bool compareGreaterThan(const Value& other) const {
-        if (type == DataType::INT && other.type == DataType::INT) {
-            return std::stoi(value) > std::stoi(other.value);
-        } else if (type == DataType::FLOAT && other.type == DataType::FLOAT) {
-            return std::stof(value) > std::stof(other.value);
-        } else if (type == DataType::INT && other.type == DataType::FLOAT) {
-            return std::stof(value) > std::stof(other.value);  // Promote INT to FLOAT
-        } else if (type == DataType::FLOAT && other.type == DataType::INT) {
-            return std::stof(value) > std::stoi(other.value);  // Promote INT to FLOAT
-        }
-        throw std::invalid_argument("Unsupported DataType for comparison");
+// Typed value of a raw literal, as it would be stored in a column of the given type:
+// malformed numbers become placeholders instead of failing
+inline Value parseRawValue(DataType type, const std::string& raw) {
+    switch (type) {
+        case DataType::INT: {
+            int64_t parsed;
+            return Value(parseInt(raw, parsed) ? parsed : INT_PLACEHOLDER);
+        }
+        case DataType::FLOAT: {
+            double parsed;
+            return Value(parseFloat(raw, parsed) ? parsed : FLOAT_PLACEHOLDER);
+        }
+        default:
+            return Value(DataType::TEXT, raw);
     }
-};
+}
 
 
 
@@ -0,0 +1,420 @@
+#ifndef WRITEAHEADLOG_H
+#define WRITEAHEADLOG_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fcntl.h>
+#include "Utils.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define WAL_OPEN _open
+#define WAL_WRITE _write
+#define WAL_CLOSE _close
+#define WAL_FSYNC _commit
+#define WAL_OPEN_FLAGS (_O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY)
+#define WAL_SYNC_FLAGS (_O_WRONLY | _O_BINARY)
+#else
+#include <unistd.h>
+#define WAL_OPEN open
+#define WAL_WRITE write
+#define WAL_CLOSE close
+#define WAL_FSYNC fsync
+#define WAL_OPEN_FLAGS (O_WRONLY | O_APPEND | O_CREAT)
+#define WAL_SYNC_FLAGS O_WRONLY
+#endif
+
+// fsync an already written file, e.g. a snapshot that must be durable before the log is dropped
+inline bool syncFile(const std::string& path) {
+    int fd = WAL_OPEN(path.c_str(), WAL_SYNC_FLAGS);
+    if (fd < 0) return false;
+    bool ok = WAL_FSYNC(fd) == 0;
+    WAL_CLOSE(fd);
+    return ok;
+}
+
+// 32-bit FNV-1a, used to detect torn or corrupt records and file headers
+inline uint32_t fnv1a(const char* data, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// When committed statements reach the log file on disk
+enum class DurabilityMode {
+    SYNC,   // write + fsync on every commit (one commit per statement)
+    GROUP,  // one write + fsync per group of `groupStatements` commits, at most `groupMillis` ms after its first
+    OFF,    // keep the log in memory until a checkpoint or exit
+};
+
+struct WalOptions {
+    DurabilityMode durability = DurabilityMode::SYNC;
+    size_t groupStatements = 32;       // GROUP: commits per flush
+    size_t groupMillis = 50;           // GROUP: the oldest unflushed commit is flushed when it is this old
+    size_t checkpointRecords = 10000;  // fold the log into the table files after this many records
+};
+
+inline DurabilityMode stringToDurabilityMode(const std::string& str) {
+    if (str == "sync") return DurabilityMode::SYNC;
+    else if (str == "group") return DurabilityMode::GROUP;
+    else if (str == "off") return DurabilityMode::OFF;
+    else throw std::invalid_argument("Unknown durability mode: " + str);
+}
+
+// Append-only log of table mutations. Every record is framed as
+//   [u32 payload length][u32 checksum][payload]
+// where payload = [u8 type][u64 lsn][record fields]. A torn or corrupt tail
+// (e.g. after a crash mid-write) is detected by the framing and discarded on replay.
+// In GROUP mode a background thread flushes a group whose first commit is groupMillis
+// old even if no further statement arrives, so the log is guarded by a mutex.
+class WriteAheadLog {
+public:
+    enum class RecordType : uint8_t {
+        CREATE_TABLE = 1,
+        DROP_TABLE = 2,
+        INSERT = 3,
+        CREATE_INDEX = 6,
+        MARK_DELETED = 7,  // rows marked as deleted
+        COMPACT = 8,       // deleted rows dropped and the rest renumbered
+        UPDATE_CELLS = 9,  // the same cells set in every listed row
+    };
+
+    struct Record {
+        Record() = default;
+        Record(RecordType type, std::string tableName) : type(type), tableName(std::move(tableName)) {}
+
+        RecordType type = RecordType::CREATE_TABLE;
+        uint64_t lsn = 0;
+        std::string tableName;
+        std::vector<std::pair<std::string, DataType>> columns; // CREATE_TABLE
+        std::vector<std::string> values;                       // INSERT (rows back to back), CREATE_INDEX (name, column, kind),
+                                                               // UPDATE_CELLS (column, raw value pairs)
+        std::vector<uint64_t> rowIds;                          // MARK_DELETED, UPDATE_CELLS
+    };
+
+    WriteAheadLog(std::string filename, const WalOptions& options)
+        : filename(std::move(filename)), options(options) {}
+
+    ~WriteAheadLog() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        groupTimer.notify_one();
+        if (flusher.joinable()) flusher.join();
+        flush();
+        if (fd >= 0) WAL_CLOSE(fd);
+    }
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Buffer a record; it reaches the file on the next commit()
+    uint64_t append(Record record) {
+        std::lock_guard<std::mutex> lock(mutex);
+        record.lsn = ++lastLsn;
+        encode(record, pending);
+        recordsSinceCheckpoint++;
+        return record.lsn;
+    }
+
+    // Ends a statement. Depending on the durability mode its records are flushed now,
+    // with the rest of their group, or at the next checkpoint / exit.
+    bool commit() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty()) return true;
+        switch (options.durability) {
+            case DurabilityMode::SYNC:
+                return flushLocked();
+            case DurabilityMode::GROUP: {
+                auto now = std::chrono::steady_clock::now();
+                if (unflushedCommits++ == 0) {
+                    groupStart = now;
+                    if (!flusher.joinable()) flusher = std::thread([this] { flushOnDeadline(); });
+                    groupTimer.notify_one();
+                }
+                if (unflushedCommits >= options.groupStatements
+                    || now - groupStart >= std::chrono::milliseconds(options.groupMillis)) {
+                    return flushLocked();
+                }
+                return true;
+            }
+            case DurabilityMode::OFF:
+                return true;
+        }
+        return true;
+    }
+
+    // Writes every buffered record with a single write and fsyncs the log
+    bool flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return flushLocked();
+    }
+
+    // Switching to SYNC flushes whatever earlier commits left buffered
+    bool setDurability(DurabilityMode mode) {
+        std::lock_guard<std::mutex> lock(mutex);
+        options.durability = mode;
+        return mode != DurabilityMode::SYNC || flushLocked();
+    }
+
+    // Replay every intact record with lsn > afterLsn. A torn tail is cut off so
+    // that later appends start right after the last valid record.
+    // Runs when the database is opened, before any commit could start the flusher.
+    bool replay(uint64_t afterLsn, const std::function<bool(const Record&)>& apply) {
+        lastLsn = afterLsn;
+        recordsSinceCheckpoint = 0;
+
+        std::ifstream ifs(filename, std::ios::binary);
+        if (!ifs.is_open()) return true; // no log yet
+
+        std::string data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        ifs.close();
+
+        size_t pos = 0, validEnd = 0;
+        while (pos + 8 <= data.size()) {
+            uint32_t length = readU32(data, pos);
+            uint32_t checksum = readU32(data, pos + 4);
+            if (pos + 8 + length > data.size() || checksumOf(data, pos + 8, length) != checksum) break;
+
+            Record record;
+            size_t cursor = pos + 8;
+            if (!decode(data, cursor, pos + 8 + length, record)) break;
+            pos += 8 + length;
+            validEnd = pos;
+
+            if (record.lsn <= afterLsn) continue; // already folded into the .db file
+            if (!apply(record)) {
+                std::cerr << "Error replaying log record " << record.lsn << " from " << filename << std::endl;
+                return false;
+            }
+            lastLsn = record.lsn;
+            recordsSinceCheckpoint++;
+        }
+
+        if (validEnd < data.size()) {
+            std::cerr << "Discarding torn tail of log file " << filename << std::endl;
+            std::error_code ec;
+            std::filesystem::resize_file(filename, validEnd, ec);
+        }
+        return true;
+    }
+
+    // Called after the .db file durably contains everything up to lastLsn
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.clear();
+        if (fd >= 0) {
+            WAL_CLOSE(fd);
+            fd = -1;
+        }
+        std::error_code ec;
+        std::filesystem::remove(filename, ec);
+        recordsSinceCheckpoint = 0;
+        unflushedCommits = 0;
+    }
+
+    [[nodiscard]] bool needsCheckpoint() const { return recordsSinceCheckpoint >= options.checkpointRecords; }
+
+    [[nodiscard]] uint64_t getLastLsn() const { return lastLsn; }
+
+private:
+    std::string filename;
+    WalOptions options;
+    int fd = -1;
+    std::string pending;
+    uint64_t lastLsn = 0;
+    size_t recordsSinceCheckpoint = 0;
+    size_t unflushedCommits = 0;                    // GROUP: commits buffered in `pending`
+    std::chrono::steady_clock::time_point groupStart; // GROUP: first of those commits
+    std::mutex mutex;
+    std::condition_variable groupTimer; // wakes the flusher when a group starts or on shutdown
+    std::thread flusher;                // started by the first GROUP commit
+    bool stopping = false;
+
+    bool flushLocked() {
+        unflushedCommits = 0;
+        if (pending.empty()) return true;
+        if (!openForAppend()) return false;
+
+        size_t written = 0;
+        while (written < pending.size()) {
+            auto n = WAL_WRITE(fd, pending.data() + written, (unsigned)(pending.size() - written));
+            if (n <= 0) {
+                std::cerr << "Error writing to log file " << filename << std::endl;
+                return false;
+            }
+            written += (size_t)n;
+        }
+        pending.clear();
+
+        if (WAL_FSYNC(fd) != 0) {
+            std::cerr << "Error syncing log file " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Flusher thread: sleeps until the current group is groupMillis old, then flushes it
+    void flushOnDeadline() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (unflushedCommits == 0 || options.durability != DurabilityMode::GROUP) {
+                groupTimer.wait(lock);
+                continue;
+            }
+            auto deadline = groupStart + std::chrono::milliseconds(options.groupMillis);
+            if (std::chrono::steady_clock::now() >= deadline) flushLocked();
+            else groupTimer.wait_until(lock, deadline);
+        }
+    }
+
+    bool openForAppend() {
+        if (fd >= 0) return true;
+        fd = WAL_OPEN(filename.c_str(), WAL_OPEN_FLAGS, 0644);
+        if (fd < 0) {
+            std::cerr << "Error opening log file " << filename << " for writing" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // -------------------
+    // Encoding helpers
+    // -------------------
+    static void putU8(std::string& out, uint8_t v) { out.push_back((char)v); }
+
+    static void putU32(std::string& out, uint32_t v) {
+        for (int i = 0; i < 4; i++) out.push_back((char)((v >> (8 * i)) & 0xFF));
+    }
+
+    static void putU64(std::string& out, uint64_t v) {
+        for (int i = 0; i < 8; i++) out.push_back((char)((v >> (8 * i)) & 0xFF));
+    }
+
+    static void putString(std::string& out, const std::string& s) {
+        putU32(out, (uint32_t)s.size());
+        out.append(s);
+    }
+
+    static uint32_t readU32(const std::string& in, size_t pos) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= (uint32_t)(uint8_t)in[pos + i] << (8 * i);
+        return v;
+    }
+
+    static uint64_t readU64(const std::string& in, size_t pos) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v |= (uint64_t)(uint8_t)in[pos + i] << (8 * i);
+        return v;
+    }
+
+    static bool getString(const std::string& in, size_t& pos, size_t end, std::string& out) {
+        if (pos + 4 > end) return false;
+        uint32_t len = readU32(in, pos);
+        pos += 4;
+        if (pos + len > end) return false;
+        out.assign(in, pos, len);
+        pos += len;
+        return true;
+    }
+
+    // FNV-1a over the payload
+    static uint32_t checksumOf(const std::string& data, size_t pos, size_t len) {
+        return fnv1a(data.data() + pos, len);
+    }
+
+    static void encode(const Record& record, std::string& out) {
+        std::string payload;
+        putU8(payload, (uint8_t)record.type);
+        putU64(payload, record.lsn);
+        putString(payload, record.tableName);
+
+        switch (record.type) {
+            case RecordType::CREATE_TABLE:
+                putU32(payload, (uint32_t)record.columns.size());
+                for (const auto& col : record.columns) {
+                    putString(payload, col.first);
+                    putU8(payload, (uint8_t)col.second);
+                }
+                break;
+            case RecordType::DROP_TABLE:
+            case RecordType::COMPACT:
+                break;
+            case RecordType::INSERT:
+            case RecordType::CREATE_INDEX:
+            case RecordType::MARK_DELETED:
+            case RecordType::UPDATE_CELLS:
+                putU32(payload, (uint32_t)record.rowIds.size());
+                for (auto id : record.rowIds) putU64(payload, id);
+                putU32(payload, (uint32_t)record.values.size());
+                for (const auto& v : record.values) putString(payload, v);
+                break;
+        }
+
+        putU32(out, (uint32_t)payload.size());
+        putU32(out, checksumOf(payload, 0, payload.size()));
+        out.append(payload);
+    }
+
+    static bool decode(const std::string& in, size_t& pos, size_t end, Record& record) {
+        if (pos + 9 > end) return false;
+        record.type = (RecordType)(uint8_t)in[pos];
+        record.lsn = readU64(in, pos + 1);
+        pos += 9;
+        if (!getString(in, pos, end, record.tableName)) return false;
+
+        switch (record.type) {
+            case RecordType::CREATE_TABLE: {
+                if (pos + 4 > end) return false;
+                uint32_t n = readU32(in, pos);
+                pos += 4;
+                for (uint32_t i = 0; i < n; i++) {
+                    std::string colName;
+                    if (!getString(in, pos, end, colName) || pos + 1 > end) return false;
+                    auto type = (DataType)(uint8_t)in[pos++];
+                    record.columns.emplace_back(colName, type);
+                }
+                return true;
+            }
+            case RecordType::DROP_TABLE:
+            case RecordType::COMPACT:
+                return true;
+            case RecordType::INSERT:
+            case RecordType::CREATE_INDEX:
+            case RecordType::MARK_DELETED:
+            case RecordType::UPDATE_CELLS: {
+                if (pos + 4 > end) return false;
+                uint32_t n = readU32(in, pos);
+                pos += 4;
+                if (pos + 8 * (size_t)n > end) return false;
+                for (uint32_t i = 0; i < n; i++, pos += 8) record.rowIds.push_back(readU64(in, pos));
+
+                if (pos + 4 > end) return false;
+                uint32_t m = readU32(in, pos);
+                pos += 4;
+                for (uint32_t i = 0; i < m; i++) {
+                    std::string v;
+                    if (!getString(in, pos, end, v)) return false;
+                    record.values.push_back(std::move(v));
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif //WRITEAHEADLOG_H
@@ -0,0 +1,153 @@
+#ifndef ZONEMAP_H
+#define ZONEMAP_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include "Utils.h"
+#include "Value.h"
+#include "Column.h"
+
+// Smallest and largest value of each block
+template <typename T>
+struct BlockRanges {
+    std::vector<T> min;
+    std::vector<T> max;
+};
+
+// Zone map of one column: rows are grouped into blocks of BLOCK_SIZE, and each block records
+// the smallest and largest value stored in it. FLOAT blocks also count their NaNs, which lie
+// outside any range (this engine has no NULLs; NaN is the value comparisons treat specially).
+// A scan skips a block whose range cannot satisfy a comparison without reading its rows.
+// Updates only widen a block and deleted rows stay in it until the map is rebuilt, so a
+// range is a bound that may be loose. Like Column, only the ranges matching `type` are used.
+class ZoneMap {
+public:
+    static constexpr size_t BLOCK_SIZE = 2048;
+
+    explicit ZoneMap(DataType type) : type(type) {}
+
+    [[nodiscard]] DataType getType() const { return type; }
+
+    [[nodiscard]] size_t blockCount() const {
+        switch (type) {
+            case DataType::INT: return ints.min.size();
+            case DataType::FLOAT: return floats.min.size();
+            default: return texts.min.size();
+        }
+    }
+
+    void build(const Column& column) {
+        ints = {};
+        floats = {};
+        nanCounts.clear();
+        texts = {};
+        extend(column, 0, column.size());
+    }
+
+    // Take the rows [begin, end) into account; they follow the rows covered so far
+    void extend(const Column& column, size_t begin, size_t end) {
+        switch (type) {
+            case DataType::INT: extendRanges(ints, column.getInts(), begin, end); break;
+            case DataType::FLOAT: extendFloats(column.getFloats(), begin, end); break;
+            case DataType::TEXT: extendRanges(texts, column.getTexts(), begin, end); break;
+        }
+    }
+
+    // The row now holds `value`: its block grows to include it
+    void widen(size_t row, const Value& value) {
+        size_t block = row / BLOCK_SIZE;
+        switch (type) {
+            case DataType::INT: widenRange(ints, block, value.getInt()); break;
+            case DataType::FLOAT:
+                if (std::isnan(value.getFloat())) nanCounts[block]++;
+                else widenRange(floats, block, value.getFloat());
+                break;
+            case DataType::TEXT: widenRange(texts, block, value.getText()); break;
+        }
+    }
+
+    // False if no row of the block can satisfy "cell op constant", compared the way
+    // BoundExpression compares cells (LE is "not greater", so NaN cells satisfy it)
+    [[nodiscard]] bool mayMatch(size_t block, CompareOp op, int64_t constant) const {
+        return rangeMayMatch(ints.min[block], ints.max[block], op, constant);
+    }
+
+    [[nodiscard]] bool mayMatch(size_t block, CompareOp op, double constant) const {
+        if (nanCounts[block] > 0 && (op == CompareOp::NE || op == CompareOp::LE || op == CompareOp::GE)) return true;
+        return rangeMayMatch(floats.min[block], floats.max[block], op, constant);
+    }
+
+    [[nodiscard]] bool mayMatch(size_t block, CompareOp op, const std::string& constant) const {
+        return rangeMayMatch(texts.min[block], texts.max[block], op, constant);
+    }
+
+    // Direct access for persistence; only the ranges matching the column type are used
+    [[nodiscard]] const BlockRanges<int64_t>& getInts() const { return ints; }
+    [[nodiscard]] const BlockRanges<double>& getFloats() const { return floats; }
+    [[nodiscard]] const std::vector<uint64_t>& getNanCounts() const { return nanCounts; }
+    [[nodiscard]] const BlockRanges<std::string>& getTexts() const { return texts; }
+
+    void assign(BlockRanges<int64_t> ranges) { ints = std::move(ranges); }
+    void assign(BlockRanges<double> ranges, std::vector<uint64_t> nans) {
+        floats = std::move(ranges);
+        nanCounts = std::move(nans);
+    }
+    void assign(BlockRanges<std::string> ranges) { texts = std::move(ranges); }
+
+private:
+    DataType type;
+    BlockRanges<int64_t> ints;
+    BlockRanges<double> floats; // over the non-NaN cells; +inf/-inf if there are none
+    std::vector<uint64_t> nanCounts;
+    BlockRanges<std::string> texts;
+
+    template <typename T>
+    static void extendRanges(BlockRanges<T>& ranges, const std::vector<T>& cells, size_t begin, size_t end) {
+        for (size_t row = begin; row < end; row++) {
+            size_t block = row / BLOCK_SIZE;
+            if (block == ranges.min.size()) {
+                ranges.min.push_back(cells[row]);
+                ranges.max.push_back(cells[row]);
+            } else {
+                widenRange(ranges, block, cells[row]);
+            }
+        }
+    }
+
+    void extendFloats(const std::vector<double>& cells, size_t begin, size_t end) {
+        for (size_t row = begin; row < end; row++) {
+            size_t block = row / BLOCK_SIZE;
+            if (block == nanCounts.size()) {
+                floats.min.push_back(std::numeric_limits<double>::infinity());
+                floats.max.push_back(-std::numeric_limits<double>::infinity());
+                nanCounts.push_back(0);
+            }
+            if (std::isnan(cells[row])) nanCounts[block]++;
+            else widenRange(floats, block, cells[row]);
+        }
+    }
+
+    template <typename T>
+    static void widenRange(BlockRanges<T>& ranges, size_t block, const T& value) {
+        if (value < ranges.min[block]) ranges.min[block] = value;
+        if (ranges.max[block] < value) ranges.max[block] = value;
+    }
+
+    template <typename T>
+    static bool rangeMayMatch(const T& min, const T& max, CompareOp op, const T& constant) {
+        switch (op) {
+            case CompareOp::EQ: return !(constant < min) && !(max < constant);
+            case CompareOp::NE: return !(min == constant && max == constant);
+            case CompareOp::LT: return min < constant;
+            case CompareOp::GT: return constant < max;
+            case CompareOp::LE: return !(constant < min);
+            case CompareOp::GE: return !(max < constant);
+        }
+        return true;
+    }
+};
+
+#endif //ZONEMAP_H
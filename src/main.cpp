@@ -7,16 +7,49 @@
 #include <string>
 #include <sstream>
 #include "../include/Parser.h"
+#include "../include/StatementStream.h"
 #include "../include/Executor.h"
 #include "../include/DatabaseManaager.h"
 
 int main(int argc, char* argv[]) {
-    if (argc == 3) {
-        std::string inputFile = argv[1];
-        std::string outputFile = argv[2];
+    // Separate "--option=value" flags from positional arguments
+    WalOptions walOptions;
+    size_t numThreads = ThreadPool::defaultThreadCount();
+    bool parseAhead = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        try {
+            if (arg.rfind("--durability=", 0) == 0) {
+                walOptions.durability = stringToDurabilityMode(arg.substr(13));
+            } else if (arg.rfind("--group-commit-statements=", 0) == 0) {
+                walOptions.groupStatements = std::stoul(arg.substr(26));
+            } else if (arg.rfind("--group-commit-ms=", 0) == 0) {
+                walOptions.groupMillis = std::stoul(arg.substr(18));
+            } else if (arg.rfind("--checkpoint-interval=", 0) == 0) {
+                walOptions.checkpointRecords = std::stoul(arg.substr(22));
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                numThreads = std::stoul(arg.substr(10));
+            } else if (arg == "--parse-ahead") {
+                parseAhead = true;
+            } else {
+                args.push_back(arg);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid option " << arg << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
 
-        // Parse commands from input file
-        std::vector<std::unique_ptr<Command>> commands = Parser::parseFile(inputFile);
+    if (args.size() == 2) {
+        std::string inputFile = args[0];
+        std::string outputFile = args[1];
+
+        std::ifstream ifs(inputFile, std::ios::binary);
+        if (!ifs.is_open()) {
+            std::cerr << "Error opening file: " << inputFile << "\n";
+            return 1;
+        }
 
         // Open output file
         std::ofstream ofs(outputFile);
@@ -25,21 +58,23 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
-        std::shared_ptr<DatabaseManager> DBM = std::make_shared<DatabaseManager>();
+        std::shared_ptr<DatabaseManager> DBM = std::make_shared<DatabaseManager>(walOptions);
         // Pass &ofs to Executor so it prints results there
-        Executor executor(DBM, ofs);
+        Executor executor(DBM, ofs, numThreads);
 
-        for (auto& cmd : commands) {
+        // Statements are parsed and executed as the script is read
+        CommandStream commands(ifs, parseAhead);
+        while (auto cmd = commands.next()) {
             executor.execute(cmd.get());
         }
 
     }
-    else if (argc == 1) {
+    else if (args.empty()) {
         std::cout << "Entering interactive mode. Type SQL commands followed by a semicolon (;) to execute.\n";
         std::cout << "Type EXIT; to quit.\n";
 
-        std::shared_ptr<DatabaseManager> DBM = std::make_shared<DatabaseManager>();
-        Executor executor(DBM); // Executor prints to std::cout by default
+        std::shared_ptr<DatabaseManager> DBM = std::make_shared<DatabaseManager>(walOptions);
+        Executor executor(DBM, std::cout, numThreads); // Executor prints to std::cout by default
 
         std::string inputBuffer;
         while (true) {
@@ -87,7 +122,14 @@ int main(int argc, char* argv[]) {
         }
     }
     else {
-        std::cerr << "Usage: " << argv[0] << " input.sql output.csv\n";
+        std::cerr << "Usage: " << argv[0] << " [options] input.sql output.csv\n"
+                  << "Options:\n"
+                  << "  --durability=sync|group|off       when statements reach the log on disk (default: sync)\n"
+                  << "  --group-commit-statements=N       'group': statements per log flush (default: 32)\n"
+                  << "  --group-commit-ms=T               'group': flush at most T ms after the oldest buffered statement (default: 50)\n"
+                  << "  --checkpoint-interval=N           log records before folding the log into the table files (default: 10000)\n"
+                  << "  --threads=N                       threads used for table scans (default: number of cores)\n"
+                  << "  --parse-ahead                     parse the next statement on a separate thread while one executes\n";
         return 1;
     }
 
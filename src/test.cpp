@@ -4,12 +4,14 @@
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <string>
 #include "../include/Value.h"
 #include "../include/Utils.h"
 #include "../include/DatabaseManaager.h"
 #include "../include/Database.h"
 #include "../include/Parser.h"
+#include "../include/StatementStream.h"
 #include "../include/Executor.h"
 
 int main(int argc, char *argv[]) {
@@ -133,16 +135,19 @@ int main(int argc, char *argv[]) {
 //    INSERT INTO student VALUES (1002, ’Bob Dylan’, 3.5);
 //    SELECT ID, Name, GPA FROM student;
 //    SELECT ID, Name, GPA FROM student WHERE GPA > 3.1 AND GPA < 3.3;)";
-//     Parser p;
-//     std::vector<std::unique_ptr<Command>> commands = p.parseMultiple(testSQL);
 
     std::string filename = "commands.sql"; // Your SQL commands file
-    std::vector<std::unique_ptr<Command>> commands = Parser::parseFile(filename);
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs.is_open()) {
+        std::cerr << "Error opening file: " << filename << "\n";
+        return 1;
+    }
 
     std::shared_ptr<DatabaseManager> DBM = std::make_shared<DatabaseManager>();
     Executor executor(DBM); // Assume Executor is properly implemented
 
-    for (auto& cmd : commands) {
+    CommandStream commands(ifs, false);
+    while (auto cmd = commands.next()) {
         executor.execute(cmd.get());
     }
 
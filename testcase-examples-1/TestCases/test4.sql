@@ -0,0 +1,15 @@
+CREATE DATABASE test_order;
+USE DATABASE test_order;
+CREATE TABLE scores (ID INTEGER, Name TEXT, Score FLOAT, Team INTEGER);
+INSERT INTO scores VALUES (1, 'Ann', 88.5, 2), (2, 'Ben', 92.0, 1), (3, 'Cid', 75.25, 2), (4, 'Dee', 92.0, 3), (5, 'Eve', 60.0, 1), (6, 'Fay', 88.5, 3);
+SELECT ID, Name, Score FROM scores ORDER BY Score DESC, ID;
+SELECT ID, Name FROM scores ORDER BY Name DESC LIMIT 3;
+SELECT ID, Score FROM scores ORDER BY Score LIMIT 2 OFFSET 2;
+SELECT ID, Score FROM scores ORDER BY Score LIMIT 10 OFFSET 4;
+SELECT ID FROM scores ORDER BY ID LIMIT 5 OFFSET 10;
+SELECT ID FROM scores ORDER BY ID LIMIT 0;
+SELECT ID, Name FROM scores LIMIT 2;
+SELECT ID, Name FROM scores LIMIT 3 OFFSET 5;
+SELECT ID, Name, Score FROM scores WHERE Team = 2 OR Team = 3 ORDER BY Score DESC, Name DESC;
+SELECT Team, COUNT(*), MAX(Score) FROM scores GROUP BY Team ORDER BY Team DESC;
+SELECT Team, COUNT(*) FROM scores GROUP BY Team ORDER BY Team LIMIT 1 OFFSET 1;
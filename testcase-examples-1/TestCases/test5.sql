@@ -0,0 +1,12 @@
+CREATE DATABASE test_copy;
+USE DATABASE test_copy;
+CREATE TABLE people (ID INTEGER, Name TEXT, City TEXT);
+INSERT INTO people VALUES (100, 'First', 'Rome'), (101, 'Second', 'Oslo');
+COPY people FROM 'testcase-examples-1/TestCases/test5.csv' HEADER;
+SELECT * FROM people;
+SELECT ID, Name FROM people WHERE City = 'Rome';
+CREATE TABLE points (X INTEGER, Y FLOAT);
+COPY points FROM 'testcase-examples-1/TestCases/test5.csv';
+SELECT * FROM points;
+INSERT INTO points VALUES (1, 1.5), (2, 2.5), (3, 3.5);
+SELECT X, Y FROM points WHERE Y > 2.0;
@@ -0,0 +1,27 @@
+CREATE DATABASE test_btree;
+USE DATABASE test_btree;
+CREATE TABLE items (ID INTEGER, Price FLOAT, Label TEXT);
+INSERT INTO items VALUES (1, 9.5, 'kiwi'), (2, 3.25, 'apple'), (3, 12.0, 'melon'), (4, 3.25, 'fig'), (5, 7.75, 'banana'), (6, 15.5, 'cherry'), (7, 0.5, 'date'), (8, 7.75, 'grape');
+CREATE INDEX idx_price ON items(Price) USING BTREE;
+CREATE INDEX idx_label ON items(Label) USING BTREE;
+SELECT ID, Price FROM items WHERE Price > 3.25 AND Price <= 12.0;
+SELECT ID, Price FROM items WHERE Price >= 3.25 AND Price < 7.75;
+SELECT ID, Label FROM items WHERE Label >= 'c' AND Label < 'g';
+SELECT ID FROM items WHERE Price = 7.75;
+SELECT ID FROM items WHERE Price > 100.0;
+SELECT ID, Price FROM items WHERE Price < 5.0 OR Price > 14.0;
+SELECT ID, Price FROM items ORDER BY Price LIMIT 3;
+SELECT ID, Price FROM items ORDER BY Price DESC LIMIT 2 OFFSET 1;
+SELECT ID, Label FROM items WHERE ID > 4 ORDER BY Label;
+INSERT INTO items VALUES (9, 5.0, 'lemon');
+SELECT ID, Price FROM items WHERE Price > 3.25 AND Price < 9.5;
+CREATE TABLE readings (ID INTEGER, Value FLOAT);
+INSERT INTO readings VALUES (1, 1.0), (2, 2.0), (3, 3.0), (4, 4.0), (5, 5.0), (6, 6.0), (7, 7.0), (8, 8.0), (9, 9.0), (10, 10.0), (11, 11.0), (12, 12.0), (13, 13.0), (14, 14.0), (15, 15.0), (16, 16.0), (17, 17.0), (18, 18.0), (19, 19.0), (20, 20.0), (99, nan), (21, 21.0), (22, 22.0), (23, 23.0), (24, 24.0), (25, 25.0), (26, 26.0), (27, 27.0), (28, 28.0), (29, 29.0), (30, 30.0), (31, 31.0), (32, 32.0), (33, 33.0), (34, 34.0), (35, 35.0), (36, 36.0), (37, 37.0), (38, 38.0), (39, 39.0), (40, 40.0);
+CREATE INDEX idx_value ON readings(Value) USING BTREE;
+SELECT ID, Value FROM readings WHERE Value <= 2.0;
+SELECT ID FROM readings WHERE Value >= 38.0;
+SELECT ID FROM readings WHERE Value > 1.0 AND Value <= 3.0;
+SELECT ID FROM readings WHERE Value >= 2.0 AND Value <= 3.0;
+SELECT ID FROM readings WHERE Value < 2.0;
+SELECT ID FROM readings WHERE Value = nan;
+SELECT ID FROM readings WHERE Value >= nan AND Value <= 1.0;
@@ -0,0 +1,26 @@
+CREATE DATABASE test_delete;
+USE DATABASE test_delete;
+CREATE TABLE orders (OrderID INTEGER, Customer TEXT, Amount FLOAT);
+CREATE TABLE customers (Customer TEXT, Region TEXT);
+CREATE INDEX idx_customer ON orders(Customer);
+CREATE INDEX idx_amount ON orders(Amount) USING BTREE;
+INSERT INTO orders VALUES (1, 'acme', 120.0), (2, 'bolt', 35.5), (3, 'acme', 80.0), (4, 'core', 220.0), (5, 'bolt', 60.0), (6, 'core', 15.0), (7, 'acme', 99.0), (8, 'dyna', 45.0);
+INSERT INTO customers VALUES ('acme', 'north'), ('bolt', 'south'), ('core', 'east'), ('dyna', 'west');
+DELETE FROM orders WHERE Amount < 40.0;
+SELECT * FROM orders;
+SELECT OrderID FROM orders WHERE Customer = 'bolt';
+SELECT OrderID, Amount FROM orders WHERE Amount >= 60.0 AND Amount <= 120.0;
+SELECT orders.OrderID, customers.Region FROM orders INNER JOIN customers ON orders.Customer = customers.Customer;
+DELETE FROM orders WHERE Customer = 'acme';
+SELECT Customer, COUNT(*), SUM(Amount) FROM orders GROUP BY Customer;
+VACUUM orders;
+SELECT * FROM orders;
+SELECT OrderID FROM orders WHERE Customer = 'core';
+SELECT OrderID FROM orders WHERE Amount > 50.0;
+INSERT INTO orders VALUES (9, 'acme', 10.0);
+SELECT * FROM orders WHERE Customer = 'acme';
+DELETE FROM orders WHERE OrderID = 100;
+DELETE FROM orders;
+SELECT * FROM orders;
+VACUUM;
+SELECT * FROM customers;
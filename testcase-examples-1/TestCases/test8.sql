@@ -0,0 +1,17 @@
+CREATE DATABASE test_update;
+USE DATABASE test_update;
+CREATE TABLE staff (ID INTEGER, Name TEXT, Dept INTEGER, Salary FLOAT);
+CREATE INDEX idx_dept ON staff(Dept);
+CREATE INDEX idx_salary ON staff(Salary) USING BTREE;
+INSERT INTO staff VALUES (1, 'Ava', 10, 5000.0), (2, 'Bo', 20, 6200.0), (3, 'Cy', 10, 4800.0), (4, 'Di', 30, 7100.0), (5, 'Ed', 20, 5500.0);
+UPDATE staff SET Dept = 30 WHERE Dept = 10;
+SELECT ID, Name FROM staff WHERE Dept = 10;
+SELECT ID, Name FROM staff WHERE Dept = 30;
+UPDATE staff SET Salary = 9000.0, Name = 'Bob' WHERE ID = 2;
+SELECT ID, Name, Salary FROM staff WHERE Salary > 6000.0;
+SELECT ID, Salary FROM staff WHERE Salary < 5200.0;
+UPDATE staff SET Salary = 5100.0, Salary = 5150.0 WHERE Name = 'Ed';
+SELECT ID, Name, Salary FROM staff WHERE Salary >= 5000.0 AND Salary <= 5500.0;
+UPDATE staff SET Dept = 40 WHERE Salary > 100000.0;
+SELECT * FROM staff ORDER BY Salary DESC;
+SELECT Dept, COUNT(*) FROM staff GROUP BY Dept;
@@ -0,0 +1,17 @@
+CREATE DATABASE test_joins;
+USE DATABASE test_joins;
+CREATE TABLE Employees (EmployeeID INTEGER, Name TEXT, DepartmentID INTEGER, Salary INTEGER);
+CREATE TABLE Departments (DepartmentID INTEGER, DepartmentName TEXT, LocationID INTEGER);
+CREATE TABLE Projects (ProjectID INTEGER, ProjectName TEXT, DepartmentID INTEGER);
+CREATE TABLE Locations (LocationID INTEGER, City TEXT);
+INSERT INTO Employees VALUES (1, 'Alice', 10, 70000), (2, 'Bob', 20, 52000), (3, 'Carol', 10, 81000), (4, 'Dan', 30, 45000), (5, 'Erin', 20, 66000), (6, 'Frank', 40, 58000), (7, 'Grace', 10, 92000), (8, 'Heidi', 30, 61000), (9, 'Ivan', 50, 49000), (10, 'Judy', 20, 75000), (11, 'Ken', 10, 54000), (12, 'Liam', 30, 83000);
+INSERT INTO Departments VALUES (10, 'Engineering', 1), (20, 'Sales', 2), (30, 'Support', 1), (40, 'Legal', 3), (50, 'Research', 2);
+INSERT INTO Projects VALUES (100, 'Apollo', 10), (101, 'Borealis', 30);
+INSERT INTO Locations VALUES (1, 'Berlin'), (2, 'Lisbon'), (3, 'Oslo');
+SELECT Employees.Name, Departments.DepartmentName, Projects.ProjectName FROM Employees INNER JOIN Departments ON Employees.DepartmentID = Departments.DepartmentID INNER JOIN Projects ON Departments.DepartmentID = Projects.DepartmentID;
+SELECT Employees.Name, Projects.ProjectName, Locations.City FROM Employees INNER JOIN Departments ON Employees.DepartmentID = Departments.DepartmentID INNER JOIN Projects ON Departments.DepartmentID = Projects.DepartmentID INNER JOIN Locations ON Departments.LocationID = Locations.LocationID WHERE Salary > 60000;
+SELECT Projects.ProjectName, COUNT(*), MAX(Employees.Salary) FROM Employees INNER JOIN Departments ON Employees.DepartmentID = Departments.DepartmentID INNER JOIN Projects ON Departments.DepartmentID = Projects.DepartmentID GROUP BY Projects.ProjectName;
+SELECT Employees.Name, Locations.City FROM Employees INNER JOIN Departments ON Employees.DepartmentID = Departments.DepartmentID INNER JOIN Locations ON Departments.LocationID = Locations.LocationID INNER JOIN Projects ON Employees.DepartmentID = Projects.DepartmentID ORDER BY Employees.Name DESC LIMIT 4;
+SELECT * FROM Locations INNER JOIN Departments ON Locations.LocationID = Departments.LocationID INNER JOIN Employees ON Departments.DepartmentID = Employees.DepartmentID INNER JOIN Projects ON Employees.DepartmentID = Projects.DepartmentID LIMIT 3;
+DELETE FROM Employees WHERE Salary < 60000;
+SELECT Employees.Name, Projects.ProjectName FROM Employees INNER JOIN Departments ON Employees.DepartmentID = Departments.DepartmentID INNER JOIN Projects ON Departments.DepartmentID = Projects.DepartmentID;